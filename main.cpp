@@ -6,9 +6,78 @@
 #include "src/cpu.h"
 #include "src/mem.h"
 
+// The tester drives a single CPU through plain functions, so the harness keeps
+// it in globals; the emulator itself has none.
 Memory g_Memory = Memory();
 CPU g_CPU(&g_Memory);
 
+/*
+ * Called once during startup. The area of memory pointed to by
+ * tester_instruction_mem will contain instructions the tester will inject,
+ * and should be mapped read-only at addresses
+ * [0,tester_instruction_mem_size).
+ */
+static void mycpu_init(size_t tester_instruction_mem_size,
+                       uint8_t *tester_instruction_mem) {
+  g_CPU.memory->memory = tester_instruction_mem;
+  g_Memory.MEM_SIZE = tester_instruction_mem_size;
+  g_Memory.mapPages();
+}
+
+/*
+ * Resets the CPU state (e.g., registers) to a given state state.
+ */
+static void mycpu_set_state(struct state *state) {
+  (void)state;
+
+  g_Memory.num_mem_accesses = 0;
+
+  g_CPU.registers.A = state->reg8.A;
+  g_CPU.registers.F.setValue(state->reg8.F);
+  g_CPU.registers.B = state->reg8.B;
+  g_CPU.registers.C = state->reg8.C;
+  g_CPU.registers.D = state->reg8.D;
+  g_CPU.registers.E = state->reg8.E;
+  g_CPU.registers.H = state->reg8.H;
+  g_CPU.registers.L = state->reg8.L;
+
+  g_CPU.SP = state->SP;
+  g_CPU.PC = state->PC;
+
+  g_CPU.halted = state->halted;
+  g_CPU.IME = state->interrupts_master_enabled;
+
+  for (int i = 0; i < 16; ++i)
+    g_Memory.mem_accesses[i] = state->mem_accesses[i];
+}
+
+static void mycpu_get_state(struct state *state) {
+  state->num_mem_accesses = g_Memory.num_mem_accesses;
+
+  state->reg8.A = g_CPU.registers.A;
+  state->reg8.F = g_CPU.registers.F.getValue();
+  state->reg8.B = g_CPU.registers.B;
+  state->reg8.C = g_CPU.registers.C;
+  state->reg8.D = g_CPU.registers.D;
+  state->reg8.E = g_CPU.registers.E;
+  state->reg8.H = g_CPU.registers.H;
+  state->reg8.L = g_CPU.registers.L;
+
+  state->SP = g_CPU.SP;
+  state->PC = g_CPU.PC;
+
+  state->halted = g_CPU.halted;
+  state->interrupts_master_enabled = g_CPU.IME;
+
+  for (int i = 0; i < 16; ++i)
+    state->mem_accesses[i] = g_Memory.mem_accesses[i];
+}
+
+static int mycpu_step(void) {
+  g_CPU.tick();
+  return g_CPU.cycles;
+}
+
 // extern struct tester_operations test_ops;
 struct tester_operations tt_ops = {
     .init = mycpu_init,
@@ -24,6 +93,54 @@ static struct tester_flags flags = {
     .print_verbose_inputs = 0,
 };
 
+// Base cost in machine cycles of every opcode (conditional branches not
+// taken), from the Pan Docs rather than the reference CPU, whose table has the
+// same typo CPU's once had. -1 marks the 0xCB prefix and unused opcodes, which
+// are never executed.
+static const int EXPECTED_CYCLES[256] = {
+    /*
+    0   1   2   3   4   5   6   7   8   9   a   b   c   d   e   f  */
+    1,  3,  2,  2,  1,  1,  2,  1,  5,  2,  2,  2,  1,  1,  2,  1,  /* 0 */
+    1,  3,  2,  2,  1,  1,  2,  1,  3,  2,  2,  2,  1,  1,  2,  1,  /* 1 */
+    2,  3,  2,  2,  1,  1,  2,  1,  2,  2,  2,  2,  1,  1,  2,  1,  /* 2 */
+    2,  3,  2,  2,  3,  3,  3,  1,  2,  2,  2,  2,  1,  1,  2,  1,  /* 3 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* 4 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* 5 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* 6 */
+    2,  2,  2,  2,  2,  2,  1,  2,  1,  1,  1,  1,  1,  1,  2,  1,  /* 7 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* 8 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* 9 */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* a */
+    1,  1,  1,  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  2,  1,  /* b */
+    2,  3,  3,  4,  3,  4,  2,  4,  2,  4,  3,  -1, 3,  6,  2,  4,  /* c */
+    2,  3,  3,  -1, 3,  4,  2,  4,  2,  4,  3,  -1, 3,  -1, 2,  4,  /* d */
+    3,  3,  2,  -1, -1, 4,  2,  4,  4,  1,  4,  -1, -1, -1, 2,  4,  /* e */
+    3,  3,  2,  1,  -1, 4,  2,  4,  3,  2,  4,  1,  -1, -1, 2,  4,  /* f */
+};
+
+// The tester only compares registers and memory, so timing is checked here
+// against EXPECTED_CYCLES. CB-prefixed instructions take 2 cycles, 4 with an
+// (HL) operand, or 3 for BIT n,(HL). Returns the number of mismatches.
+static int check_cycle_counts(void) {
+  int mismatches = 0;
+
+  for (int i = 0; i < 512; ++i) {
+    int opcode = i & 0xFF;
+    int expected = EXPECTED_CYCLES[opcode];
+    if (i >= 0x100)
+      expected = (opcode & 7) != 6 ? 2 : (opcode >> 6) == 1 ? 3 : 4;
+    if (expected < 0 || OPCODE_TABLE[i].cycles == expected) continue;
+
+    printf("Wrong cycle count for %s%02X: %d, expected %d\n",
+           i >= 0x100 ? "CB " : "", opcode, OPCODE_TABLE[i].cycles, expected);
+    ++mismatches;
+  }
+
+  printf("Checked cycle counts of 256 opcodes and 256 CB opcodes, %d wrong\n",
+         mismatches);
+  return mismatches;
+}
+
 static void print_usage(char *progname) {
   printf("Usage: %s [option]...\n\n", progname);
   printf("Game Boy Instruction Tester.\n\n");
@@ -94,5 +211,8 @@ int main(int argc, char **argv) {
 
   g_Memory.shouldWriteToMemory = false;
 
-  return tester_run(&flags, &tt_ops);
+  int cycle_mismatches = check_cycle_counts();
+  if (cycle_mismatches != 0 && !flags.keep_going_on_mismatch) return 1;
+
+  return tester_run(&flags, &tt_ops) != 0 || cycle_mismatches != 0;
 }
@@ -0,0 +1,136 @@
+#include "batch.h"
+
+#include <_types/_uint64_t.h>
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "events.h"
+#include "gameboy.h"
+#include "romimage.h"
+#include "utils.h"
+
+// ROMs waiting to be run by one worker. Workers take from the front of their
+// own queue and, once it runs dry, steal from the back of the others', so a
+// few slow ROMs don't leave the other threads idle.
+struct WorkQueue {
+  std::mutex mutex;
+  std::deque<size_t> jobs;
+};
+
+static bool popFront(WorkQueue &queue, size_t &job) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty()) return false;
+
+  job = queue.jobs.front();
+  queue.jobs.pop_front();
+  return true;
+}
+
+static bool popBack(WorkQueue &queue, size_t &job) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty()) return false;
+
+  job = queue.jobs.back();
+  queue.jobs.pop_back();
+  return true;
+}
+
+struct RomRun {
+  GameBoy *gb;
+  BatchResult *result;
+  std::string line = "";
+};
+
+static void onSerialWrite(GameboyEventData data, void *context) {
+  RomRun &run = *(RomRun *)context;
+  if (data.memory.value8 != 0x81) return;
+
+  char c = (char)data.memory.memory[0xFF01];
+  run.result->serialOutput += c;
+  run.line = c == '\n' ? "" : run.line + c;
+
+  if (run.line == "Passed" || run.line == "Failed") {
+    run.result->finished = true;
+    run.result->passed = run.line == "Passed";
+    run.gb->isRunning = false;
+  }
+}
+
+static void runRom(const std::string &path, uint64_t maxCycles,
+                   CPU::ExecutionMode mode, bool idleLoopSkipping,
+                   BatchResult &result) {
+  uint64_t start = getTimeNanoseconds();
+  result.romPath = path;
+
+  std::shared_ptr<RomImage> rom = RomImage::open(path.c_str());
+  if (rom == NULL) {
+    result.error = "Failed to read rom file";
+    return;
+  }
+
+  // Too big to comfortably put on a worker thread's stack.
+  std::unique_ptr<GameBoy> gb = std::make_unique<GameBoy>();
+  gb->setSpeed(0);
+  gb->setExecutionMode(mode);
+  gb->setIdleLoopSkipping(idleLoopSkipping);
+  gb->setTickLimit(maxCycles);
+
+  RomRun run = {gb.get(), &result};
+  gb->addWatch(MEM_WRITE_BYTE, 0xFF02, 0xFF02, onSerialWrite, &run);
+
+  // An unsupported cartridge or a missing boot ROM fails only this ROM.
+  try {
+    gb->loadRom(rom);
+    gb->run();
+  } catch (const std::exception &e) {
+    result.error = e.what();
+    return;
+  }
+
+  result.cycles = gb->getTicks();
+  result.nanoseconds = getTimeNanoseconds() - start;
+}
+
+BatchRunner::BatchRunner(size_t threads) : threads(threads) {
+  if (this->threads == 0)
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<BatchResult> BatchRunner::run(
+    const std::vector<std::string> &romPaths, uint64_t maxCycles,
+    CPU::ExecutionMode mode, bool idleLoopSkipping) {
+  std::vector<BatchResult> results(romPaths.size());
+  size_t workers = std::min(threads, romPaths.size());
+  if (workers == 0) return results;
+
+  std::vector<WorkQueue> queues(workers);
+  for (size_t i = 0; i < romPaths.size(); ++i)
+    queues[i % workers].jobs.push_back(i);
+
+  // No jobs are added once the workers start, so a worker that finds every
+  // queue empty is done.
+  auto work = [&](size_t self) {
+    size_t job;
+
+    while (true) {
+      bool found = popFront(queues[self], job);
+      for (size_t i = 1; !found && i < workers; ++i)
+        found = popBack(queues[(self + i) % workers], job);
+      if (!found) return;
+
+      runRom(romPaths[job], maxCycles, mode, idleLoopSkipping, results[job]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < workers; ++i) pool.emplace_back(work, i);
+  work(0);
+  for (std::thread &thread : pool) thread.join();
+
+  return results;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <_types/_uint64_t.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "cpu.h"
+
+// Outcome of running one ROM. Test ROMs such as Blargg's report over the
+// serial port, ending with a line reading "Passed" or "Failed".
+struct BatchResult {
+  std::string romPath;
+  std::string error;  // Why the ROM couldn't be run, if it couldn't.
+  std::string serialOutput;
+  bool finished = false;  // Reported a result before the cycle limit.
+  bool passed = false;
+
+  uint64_t cycles = 0;       // T-cycles emulated.
+  uint64_t nanoseconds = 0;  // Wall time taken.
+};
+
+// Runs independent GameBoy instances, one per ROM, on a fixed number of worker
+// threads.
+class BatchRunner {
+ public:
+  // Uses one thread per core if threads is 0.
+  BatchRunner(size_t threads = 0);
+
+  // Runs each ROM until it reports a result or has emulated maxCycles
+  // T-cycles (0 for no limit). Results are in the same order as romPaths.
+  std::vector<BatchResult> run(
+      const std::vector<std::string> &romPaths, uint64_t maxCycles = 0,
+      CPU::ExecutionMode mode = CPU::ExecutionMode::CACHED_BLOCKS,
+      bool idleLoopSkipping = true);
+
+  size_t getThreadCount() { return threads; };
+
+ private:
+  size_t threads;
+};
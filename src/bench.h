@@ -0,0 +1,93 @@
+#pragma once
+
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "cpu.h"
+#include "mem.h"
+#include "tiledecode.h"
+#include "utils.h"
+
+// The per-pixel mask loop decodeTileRow replaced, kept as the baseline.
+static void decodeTileRowLoop(uint8_t low, uint8_t high, uint8_t out[8]) {
+  for (int col = 0; col < 8; ++col) {
+    uint8_t mask = 1 << (7 - col);
+    out[col] = ((low & mask) != 0 ? 1 : 0) | ((high & mask) != 0 ? 2 : 0);
+  }
+}
+
+template <void (*decode)(uint8_t, uint8_t, uint8_t[8])>
+static void benchmarkTileDecoder(const char *name,
+                                 const std::vector<uint8_t> &vram) {
+  static const int ITERATIONS = 2000;
+  uint8_t pixels[8];
+  uint64_t checksum = 0;
+
+  uint64_t start = getTimeNanoseconds();
+  for (int i = 0; i < ITERATIONS; ++i) {
+    for (size_t row = 0; row + 1 < vram.size(); row += 2) {
+      decode(vram[row], vram[row + 1], pixels);
+      checksum += pixels[i & 7];
+    }
+  }
+  uint64_t elapsed = getTimeNanoseconds() - start;
+
+  double rows = (double)ITERATIONS * (vram.size() / 2);
+  printf("%-12s %6.2f ns/row (checksum %llu)\n", name, elapsed / rows,
+         (unsigned long long)checksum);
+}
+
+// Decodes a tile data area's worth (384 tiles) of pseudo-random rows with
+// each decoder.
+void runTileDecodeBenchmark() {
+  std::vector<uint8_t> vram(384 * 16);
+  uint32_t seed = 1;
+  for (uint8_t &byte : vram) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+
+  benchmarkTileDecoder<decodeTileRowLoop>("mask loop", vram);
+  benchmarkTileDecoder<decodeTileRow>("decoder", vram);
+}
+
+// Runs a loop of 128 pseudo-random CB-prefixed instructions (rotates, shifts,
+// SWAP, BIT, RES and SET) through CPU::tick, about one in six on (HL) and the
+// rest on registers. H and L are left alone so (HL) stays on its scratch
+// byte in WRAM.
+void runCBBenchmark() {
+  static const int PASSES = 20000;
+  static const int LENGTH = 128;
+  static const uint8_t TARGETS[] = {0, 1, 2, 3, 6, 7};  // B C D E (HL) A
+
+  Memory memory;
+  CPU cpu(&memory);
+
+  uint16_t address = 0xC000;
+  uint32_t seed = 1;
+  for (int i = 0; i < LENGTH; ++i) {
+    seed = seed * 1103515245 + 12345;
+    uint8_t opcode = (seed >> 16) & 0xF8;
+    memory.writeByte(address++, 0xCB, false);
+    memory.writeByte(address++, opcode | TARGETS[(seed >> 24) % 6], false);
+  }
+  memory.writeByte(address++, 0xC3, false);  // JP $C000
+  memory.writeWord(address, 0xC000);
+
+  cpu.registers.H = 0xD0;
+  cpu.registers.L = 0x00;
+  cpu.setPC(0xC000);
+
+  uint64_t start = getTimeNanoseconds();
+  for (int pass = 0; pass < PASSES; ++pass)
+    for (int i = 0; i <= LENGTH; ++i) cpu.tick();
+  uint64_t elapsed = getTimeNanoseconds() - start;
+
+  double instructions = (double)PASSES * (LENGTH + 1);
+  printf("%-12s %6.2f ns/instruction (checksum %d)\n", "CB ops",
+         elapsed / instructions,
+         cpu.registers.A + cpu.registers.B + memory.readByte(0xD000));
+}
@@ -0,0 +1,130 @@
+#include "blockcache.h"
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint8_t.h>
+
+#include <algorithm>
+
+#include "cpu.h"
+#include "mem.h"
+
+// Whether the instruction can leave straight-line execution, or change
+// whether interrupts are taken (EI, DI and RETI), which the CPU checks
+// between blocks.
+static bool endsBlock(uint8_t opcode) {
+  switch (opcode) {
+    case (int)Instruction::Type::DI:
+    case (int)Instruction::Type::EI:
+    case (int)Instruction::Type::STOP:
+    case (int)Instruction::Type::JR_s8:
+    case (int)Instruction::Type::JR_NZ_s8:
+    case (int)Instruction::Type::JR_Z_s8:
+    case (int)Instruction::Type::JR_NC_s8:
+    case (int)Instruction::Type::JR_C_s8:
+    case (int)Instruction::Type::HALT:
+    case (int)Instruction::Type::RET_NZ:
+    case (int)Instruction::Type::RET_Z:
+    case (int)Instruction::Type::RET:
+    case (int)Instruction::Type::RET_NC:
+    case (int)Instruction::Type::RET_C:
+    case (int)Instruction::Type::RETI:
+    case (int)Instruction::Type::JP_NZ_a16:
+    case (int)Instruction::Type::JP_a16:
+    case (int)Instruction::Type::JP_Z_a16:
+    case (int)Instruction::Type::JP_NC_a16:
+    case (int)Instruction::Type::JP_C_a16:
+    case (int)Instruction::Type::JP_HL:
+    case (int)Instruction::Type::CALL_NZ_a16:
+    case (int)Instruction::Type::CALL_Z_a16:
+    case (int)Instruction::Type::CALL_a16:
+    case (int)Instruction::Type::CALL_NC_a16:
+    case (int)Instruction::Type::CALL_C_a16:
+      return true;
+
+    default:
+      // RST n
+      return (opcode & 0xC7) == 0xC7;
+  }
+}
+
+Block *BlockCache::get(uint16_t address) {
+  auto it = blocks.find(address);
+  if (it != blocks.end()) return it->second.get();
+  return decode(address);
+}
+
+Block *BlockCache::decode(uint16_t address) {
+  std::unique_ptr<Block> block = std::make_unique<Block>();
+  block->start = address;
+
+  // Peek rather than read so building a block doesn't fire memory watches.
+  uint32_t pc = address;
+  while (block->instructions.size() < MAX_BLOCK_LENGTH &&
+         pc < memory->MEM_SIZE) {
+    uint8_t opcode = memory->peekByte(pc);
+    const Opcode *op = opcode == 0xCB
+                           ? &OPCODE_TABLE[0x100 | memory->peekByte(pc + 1)]
+                           : &OPCODE_TABLE[opcode];
+
+    block->instructions.push_back(op);
+    pc += op->length;
+
+    if (endsBlock(opcode) || pc > 0xFFFF) break;
+  }
+
+  // An instruction running past 0xFFFF wraps around to 0x0000 like the PC,
+  // but the block still only covers pages up to 0xFF.
+  block->end = pc;
+
+  for (uint32_t page = block->start >> 8; page <= lastPage(block.get());
+       ++page) {
+    if (pageBlocks[page].empty()) memory->setCodePage((uint8_t)page, true);
+    pageBlocks[page].push_back(block->start);
+  }
+
+  Block *result = block.get();
+  blocks[address] = std::move(block);
+  return result;
+}
+
+void BlockCache::invalidateBlocksAt(uint16_t address) {
+  std::vector<uint16_t> &starts = pageBlocks[address >> 8];
+
+  for (size_t i = 0; i < starts.size();) {
+    Block *block = blocks[starts[i]].get();
+
+    if (address < block->start || address >= block->end)
+      ++i;
+    else
+      drop(block->start);
+  }
+}
+
+void BlockCache::invalidatePage(uint8_t page) {
+  std::vector<uint16_t> &starts = pageBlocks[page];
+  while (!starts.empty()) drop(starts.back());
+}
+
+void BlockCache::drop(uint16_t start) {
+  auto it = blocks.find(start);
+  Block *block = it->second.get();
+
+  for (uint32_t page = block->start >> 8; page <= lastPage(block); ++page) {
+    std::vector<uint16_t> &starts = pageBlocks[page];
+    starts.erase(std::find(starts.begin(), starts.end(), block->start));
+    if (starts.empty()) memory->setCodePage((uint8_t)page, false);
+  }
+
+  blocks.erase(it);
+  ++generation_;
+}
+
+void BlockCache::clear() {
+  blocks.clear();
+  for (size_t page = 0; page < 0x100; ++page) {
+    if (pageBlocks[page].empty()) continue;
+    pageBlocks[page].clear();
+    memory->setCodePage((uint8_t)page, false);
+  }
+  ++generation_;
+}
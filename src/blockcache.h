@@ -0,0 +1,70 @@
+#pragma once
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint32_t.h>
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Memory;
+struct Opcode;
+
+// A straight-line run of pre-decoded instructions. A block ends after the
+// first instruction that can transfer control (jumps, calls, returns, RST,
+// HALT and STOP) or enable or disable interrupts (EI and DI), or when it
+// reaches MAX_BLOCK_LENGTH instructions.
+struct Block {
+  uint16_t start;
+  uint32_t end;  // One past the last byte, 0x10000 or more at the top.
+  std::vector<const Opcode *> instructions;
+};
+
+class BlockCache {
+ public:
+  BlockCache(Memory *m) : memory(m){};
+
+  // Returns the block starting at address, decoding it on a miss.
+  Block *get(uint16_t address);
+
+  // Drops every block containing address. Memory marks pages holding cached
+  // code so that only writes to those pages reach this.
+  void invalidate(uint16_t address) {
+    if (pageBlocks[address >> 8].empty()) return;
+    invalidateBlocksAt(address);
+  }
+
+  // Drops every block overlapping the page, e.g. when a different ROM bank is
+  // mapped there.
+  void invalidatePage(uint8_t page);
+
+  void clear();
+
+  // Bumped whenever a block is dropped, so callers holding a Block pointer
+  // can tell it may have been freed.
+  uint64_t generation() { return generation_; };
+
+  static const size_t MAX_BLOCK_LENGTH = 64;
+
+ private:
+  Block *decode(uint16_t address);
+  void invalidateBlocksAt(uint16_t address);
+  void drop(uint16_t start);
+
+  // Last page holding a byte of the block.
+  static uint32_t lastPage(const Block *block) {
+    return std::min<uint32_t>((block->end - 1) >> 8, 0xFF);
+  }
+
+  Memory *memory;
+  uint64_t generation_ = 0;
+
+  std::unordered_map<uint16_t, std::unique_ptr<Block>> blocks;
+
+  // Start addresses of the blocks overlapping each 256-byte page.
+  std::vector<uint16_t> pageBlocks[0x100];
+};
@@ -0,0 +1,186 @@
+#include "cartridge.h"
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint8_t.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+static size_t ramSize(uint8_t code) {
+  switch (code) {
+    case 0x01:
+      return 0x800;
+    case 0x02:
+      return 0x2000;
+    case 0x03:
+      return 0x8000;
+    case 0x04:
+      return 0x20000;
+    case 0x05:
+      return 0x10000;
+    default:
+      return 0;
+  }
+}
+
+Cartridge::Cartridge(std::shared_ptr<RomImage> r) : rom(std::move(r)) {
+  uint8_t typeCode = rom->data()[TYPE_ADDR];
+  switch (typeCode) {
+    case 0x00:
+    case 0x08:
+    case 0x09:
+      type = Type::ROM_ONLY;
+      ramEnabled = true;
+      break;
+    case 0x01:
+    case 0x02:
+    case 0x03:
+      type = Type::MBC1;
+      break;
+    case 0x0F:
+    case 0x10:
+    case 0x11:
+    case 0x12:
+    case 0x13:
+      type = Type::MBC3;
+      break;
+    case 0x19:
+    case 0x1A:
+    case 0x1B:
+    case 0x1C:
+    case 0x1D:
+    case 0x1E:
+      type = Type::MBC5;
+      break;
+    default:
+      throw std::runtime_error("Unsupported cartridge type: " +
+                               std::to_string(typeCode));
+  }
+
+  size_t ramBytes = ramSize(rom->data()[RAM_SIZE_ADDR]);
+  if (ramBytes != 0) ram.resize(std::max(ramBytes, RAM_BANK_SIZE), 0);
+
+  updateBanks();
+}
+
+uint32_t Cartridge::getRomHash() {
+  if (romHash != 0) return romHash;
+
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < rom->size(); ++i)
+    hash = (hash ^ rom->data()[i]) * 16777619u;
+  romHash = hash != 0 ? hash : 1;
+  return romHash;
+}
+
+uint8_t* Cartridge::ramBank() {
+  if (!ramEnabled || ram.empty()) return NULL;
+  if (type == Type::MBC3 && ramBankIndex >= 0x08) return NULL;
+
+  size_t banks = ram.size() / RAM_BANK_SIZE;
+  return ram.data() + ramBankIndex % banks * RAM_BANK_SIZE;
+}
+
+void Cartridge::writeRegister(uint16_t address, uint8_t value) {
+  if (type == Type::ROM_ONLY) return;
+
+  if (address < 0x2000) {
+    ramEnabled = (value & 0x0F) == 0x0A;
+  } else if (address < 0x4000) {
+    if (type != Type::MBC5)
+      romBankRegister = value;
+    else if (address < 0x3000)
+      romBankRegister = (romBankRegister & 0x100) | value;
+    else
+      romBankRegister = (romBankRegister & 0xFF) | (value & 0x01) << 8;
+  } else if (address < 0x6000) {
+    ramBankRegister = value;
+  } else if (type == Type::MBC1) {
+    advancedBanking = (value & 0x01) != 0;
+  }
+
+  updateBanks();
+}
+
+uint8_t Cartridge::readRam(uint16_t address) {
+  if (!ramEnabled) return 0xFF;
+  if (type == Type::MBC3 && ramBankIndex >= 0x08)
+    return ramBankIndex <= 0x0C ? rtc[ramBankIndex - 0x08] : 0xFF;
+
+  uint8_t* bank = ramBank();
+  return bank != NULL ? bank[address - 0xA000] : 0xFF;
+}
+
+void Cartridge::writeRam(uint16_t address, uint8_t value) {
+  if (!ramEnabled) return;
+  if (type == Type::MBC3 && ramBankIndex >= 0x08) {
+    if (ramBankIndex <= 0x0C) rtc[ramBankIndex - 0x08] = value;
+    return;
+  }
+
+  uint8_t* bank = ramBank();
+  if (bank != NULL) bank[address - 0xA000] = value;
+}
+
+void Cartridge::save(Snapshot& snapshot) {
+  snapshot.ramEnabled = ramEnabled;
+  snapshot.romBankRegister = romBankRegister;
+  snapshot.ramBankRegister = ramBankRegister;
+  snapshot.advancedBanking = advancedBanking;
+  memcpy(snapshot.rtc, rtc, sizeof(rtc));
+  memcpy(snapshot.ram, ram.data(), ram.size());
+}
+
+void Cartridge::load(const Snapshot& snapshot) {
+  ramEnabled = snapshot.ramEnabled;
+  romBankRegister = snapshot.romBankRegister;
+  ramBankRegister = snapshot.ramBankRegister;
+  advancedBanking = snapshot.advancedBanking;
+  memcpy(rtc, snapshot.rtc, sizeof(rtc));
+  memcpy(ram.data(), snapshot.ram, ram.size());
+  updateBanks();
+}
+
+void Cartridge::updateBanks() {
+  switch (type) {
+    case Type::ROM_ONLY:
+      lowBank = 0;
+      highBank = 1;
+      ramBankIndex = 0;
+      break;
+
+    case Type::MBC1: {
+      // Bank 00h can't be selected at 4000-7FFF, but the zero check only
+      // looks at the lower 5 bits, so 20h/40h/60h map to 21h/41h/61h.
+      size_t bank = romBankRegister & 0x1F;
+      if (bank == 0) bank = 1;
+      size_t upper = ramBankRegister & 0x03;
+
+      highBank = bank | upper << 5;
+      lowBank = advancedBanking ? upper << 5 : 0;
+      ramBankIndex = advancedBanking ? upper : 0;
+      break;
+    }
+
+    case Type::MBC3:
+      highBank = romBankRegister & 0x7F;
+      if (highBank == 0) highBank = 1;
+      lowBank = 0;
+      ramBankIndex = ramBankRegister;
+      break;
+
+    case Type::MBC5:
+      highBank = romBankRegister & 0x1FF;
+      lowBank = 0;
+      ramBankIndex = ramBankRegister & 0x0F;
+      break;
+  }
+
+  size_t banks = rom->size() / ROM_BANK_SIZE;
+  lowBank %= banks;
+  highBank %= banks;
+}
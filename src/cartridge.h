@@ -0,0 +1,100 @@
+#pragma once
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint32_t.h>
+#include <_types/_uint8_t.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "romimage.h"
+
+class Cartridge {
+  /*
+      0000-3FFF - ROM Bank 00 (Read Only)
+      4000-7FFF - ROM Bank 01-NN (Read Only)
+      A000-BFFF - External RAM Bank 00-NN, if any (Read/Write)
+
+      Writes to 0000-7FFF don't modify the ROM, they set the memory bank
+     controller registers:
+        MBC1: 0000-1FFF RAM Enable (0Ah enables), 2000-3FFF ROM Bank Number
+              (lower 5 bits, 00h acts as 01h), 4000-5FFF RAM Bank Number or
+              upper bits of the ROM Bank Number, 6000-7FFF Banking Mode
+        MBC3: 0000-1FFF RAM and RTC Enable, 2000-3FFF ROM Bank Number (7
+              bits, 00h acts as 01h), 4000-5FFF RAM Bank Number (00-03h) or
+              RTC Register Select (08-0Ch), 6000-7FFF Latch Clock Data
+        MBC5: 0000-1FFF RAM Enable, 2000-2FFF lower 8 bits of the ROM Bank
+              Number, 3000-3FFF bit 8 of the ROM Bank Number, 4000-5FFF RAM
+              Bank Number (00-0Fh)
+  */
+
+ public:
+  enum class Type { ROM_ONLY, MBC1, MBC3, MBC5 };
+
+  // Parses the header of the ROM image, which may be shared with other
+  // cartridges. Throws if the cartridge type isn't supported.
+  Cartridge(std::shared_ptr<RomImage> rom);
+
+  Type getType() { return type; };
+
+  // Hash of the whole ROM, to tell images apart. Homebrew often leaves the
+  // header checksum blank. Computed on first use.
+  uint32_t getRomHash();
+
+  // Memory maps these straight into its page table, so switching banks only
+  // swaps pointers. ramBank returns NULL while RAM is disabled, absent or an
+  // RTC register is selected; accesses then go through readRam/writeRam.
+  const uint8_t* romBank0() { return rom->data() + lowBank * ROM_BANK_SIZE; };
+  const uint8_t* romBankN() { return rom->data() + highBank * ROM_BANK_SIZE; };
+  uint8_t* ramBank();
+
+  void writeRegister(uint16_t address, uint8_t value);
+  uint8_t readRam(uint16_t address);
+  void writeRam(uint16_t address, uint8_t value);
+
+  static constexpr size_t ROM_BANK_SIZE = 0x4000;
+  static constexpr size_t RAM_BANK_SIZE = 0x2000;
+  static constexpr size_t MAX_RAM_SIZE = 0x20000;
+
+  // Bank registers and RAM, for save states. Only as much of `ram` as the
+  // cartridge has is copied.
+  struct Snapshot {
+    bool ramEnabled;
+    uint16_t romBankRegister;
+    uint8_t ramBankRegister;
+    bool advancedBanking;
+    uint8_t rtc[5];
+    uint8_t ram[MAX_RAM_SIZE];
+  };
+  void save(Snapshot& snapshot);
+  void load(const Snapshot& snapshot);
+
+ private:
+  void updateBanks();
+
+  std::shared_ptr<RomImage> rom;
+  std::vector<uint8_t> ram;
+  Type type;
+
+  // Raw register values as written by the game.
+  bool ramEnabled = false;
+  uint16_t romBankRegister = 1;
+  uint8_t ramBankRegister = 0;
+  bool advancedBanking = false;  // MBC1 banking mode 1.
+
+  // Banks currently mapped at 0000-3FFF and 4000-7FFF, and the RAM bank (or
+  // RTC register, 08-0Ch on MBC3) at A000-BFFF.
+  size_t lowBank = 0;
+  size_t highBank = 1;
+  size_t ramBankIndex = 0;
+
+  // MBC3 clock registers. The clock isn't advanced; games can still read
+  // back what they wrote.
+  uint8_t rtc[5] = {};
+
+  uint32_t romHash = 0;  // 0 until computed.
+
+  static constexpr uint16_t TYPE_ADDR = 0x0147;
+  static constexpr uint16_t RAM_SIZE_ADDR = 0x0149;
+};
@@ -7,12 +7,14 @@
 #include <sys/_types/_int8_t.h>
 
 #include <__errc>
+#include <array>
 #include <bitset>
 #include <cstdio>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "../lib/tester.h"
 #include "mem.h"
@@ -26,2146 +28,1973 @@ uint16_t signedAdd(uint16_t a, uint8_t b) {
 
 // #define DEBUG_LOG ;  // Comment out to disable instruction logging.
 
-// Executes an instruction and returns the next PC.
-uint16_t CPU::executeInstruction(Instruction *instruction) {
-#ifdef DEBUG_LOG
-  printf(
-      "IME=%d LY: %02X A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X "
-      "SP:%04X "
-      "PC:%04X "
-      "PCMEM:%02X,%02X,%02X,%02X OP:%02X %s\n",
-      IME ? 1 : 0, memory->readByte(0xFF44), registers.A,
-      registers.F.getValue(), registers.B, registers.C, registers.D,
-      registers.E, registers.H, registers.L, SP, PC, memory->readByte(PC + 1),
-      memory->readByte(PC + 2), memory->readByte(PC + 3),
-      memory->readByte(PC + 4), memory->readByte(PC),
-      instruction->TypeRepr().c_str());
-#endif
+// =========================
+// ==== OPCODE HANDLERS ====
+// =========================
+
+// Every opcode is executed by its own specialization of CPU::execute. The
+// handler is responsible for advancing the PC; the base cycle cost is added by
+// CPU::tick from the opcode table, so handlers only account for the extra
+// cycles of a taken branch.
+
+template <uint8_t x, uint8_t y>
+void CPU::executePrefixed(uint8_t &value) {
+  if constexpr (x == 0) {
+    if constexpr (y == 0) rlc(value);
+    if constexpr (y == 1) rrc(value);
+    if constexpr (y == 2) rl(value);
+    if constexpr (y == 3) rr(value);
+    if constexpr (y == 4) sla(value);
+    if constexpr (y == 5) sra(value);
+    if constexpr (y == 6) swap(value);
+    if constexpr (y == 7) srl(value);
+  } else if constexpr (x == 1) {
+    bit(value, y);
+  } else if constexpr (x == 2) {
+    value &= (0xFF ^ (1 << y));
+  } else {
+    value |= (1 << y);
+  }
+}
 
-  if (((int)instruction->type() >> 8) == 0xCB) {
-    uint8_t opcode = (int)instruction->type();
-
-    uint8_t x = opcode >> 6;          // 1st octal digit (i.e. bits 7-6)
-    uint8_t y = (opcode >> 3) & 0x7;  // 2nd octal digit (i.e. bits 5-3)
-    uint8_t z = opcode & 0x7;         // 3rd octal digit (i.e. bits 2-0)
-
-    ArithmeticTarget target = (ArithmeticTarget)z;
-
-    updateHL_mem();
-
-    switch (x) {
-      case 0: {
-        switch (y) {
-          case 0:
-            rlc(*getTargetRef(target));
-            break;
-
-          case 1:
-            rrc(*getTargetRef(target));
-            break;
-
-          case 2:
-            rl(*getTargetRef(target));
-            break;
-
-          case 3:
-            rr(*getTargetRef(target));
-            break;
-
-          case 4:
-            sla(*getTargetRef(target));
-            break;
-
-          case 5:
-            sra(*getTargetRef(target));
-            break;
-
-          case 6:
-            swap(*getTargetRef(target));
-            break;
-
-          case 7:
-            srl(*getTargetRef(target));
-            break;
-        }
-
-        cycles += (target == HL ? 4 : 2);
-        break;
-      }
-
-      case 1: {
-        bit(*getTargetRef(target), y);
-        cycles += (target == HL ? 3 : 2);
-        break;
-      }
-
-      case 2: {
-        uint8_t *targetRef = getTargetRef(target);
-        *targetRef = *targetRef & (0xFF ^ (1 << y));
-        cycles += (target == HL ? 4 : 2);
-        break;
-      }
-
-      case 3: {
-        uint8_t *targetRef = getTargetRef(target);
-        *targetRef = *targetRef | (1 << y);
-        cycles += (target == HL ? 4 : 2);
-        break;
-      }
-    }
+// Opcodes without a dedicated specialization are either CB-prefixed, decoded
+// at compile time from the x/y/z octal digits of the opcode, or unused by the
+// SM83. Register targets operate in place; only (HL) targets touch memory, and
+// BIT n,(HL) never writes back.
+template <Instruction::Type T>
+void CPU::execute() {
+  constexpr uint16_t value = (uint16_t)T;
+
+  if constexpr ((value >> 8) == 0xCB) {
+    constexpr uint8_t opcode = value & 0xFF;
+
+    constexpr uint8_t x = opcode >> 6;          // 1st octal digit (bits 7-6)
+    constexpr uint8_t y = (opcode >> 3) & 0x7;  // 2nd octal digit (bits 5-3)
+    constexpr uint8_t z = opcode & 0x7;         // 3rd octal digit (bits 2-0)
 
-    if (target == HL && x != 1) memory->writeByte(registers.get_HL(), HL_mem);
+    constexpr ArithmeticTarget target = (ArithmeticTarget)z;
+
+    if constexpr (target == HL) {
+      uint16_t address = registers.get_HL();
+      uint8_t operand = memory->readByte(address);
+      executePrefixed<x, y>(operand);
+      if constexpr (x != 1) memory->writeByte(address, operand);
+    } else {
+      executePrefixed<x, y>(getTargetRef<target>());
+    }
 
     setPC(PC + 2);
-    return PC;
+  } else {
+    throw std::runtime_error(
+        std::string("Encountered invalid instruction opcode: ") +
+        std::to_string(value));
   }
+}
 
-  switch (instruction->type()) {
-    // Only advances the program counter by 1. Performs no other operations
-    // that would have an effect.
-    case Instruction::Type::NOP: {
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Only advances the program counter by 1. Performs no other operations
+// that would have an effect.
+template <>
+void CPU::execute<Instruction::Type::NOP>() {
+  incrementPC();
+}
 
-    case Instruction::Type::HALT: {
-      halted = true;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 2 bytes of immediate data into register pair BC.
+template <>
+void CPU::execute<Instruction::Type::LD_BC_d16>() {
+  registers.set_BC(memory->readWord(PC + 1));
+  setPC(PC + 3);
+}
 
-    // Load the 2 bytes of immediate data into register pair SP.
-    case Instruction::Type::LD_SP_d16: {
-      SP = memory->readWord(PC + 1);
-      setPC(PC + 3);
-      cycles += 3;
-      break;
-    }
+// Store the contents of register A in the memory location specified by
+// register pair BC.
+template <>
+void CPU::execute<Instruction::Type::LD_BC_A>() {
+  memory->writeByte(registers.get_BC(), registers.A);
+  incrementPC();
+}
 
-    // Load the 2 bytes of immediate data into register pair HL.
-    case Instruction::Type::LD_HL_d16: {
-      registers.set_HL(memory->readWord(PC + 1));
-      setPC(PC + 3);
-      cycles += 3;
-      break;
-    }
+// Increment the contens of register pair BC by 1
+template <>
+void CPU::execute<Instruction::Type::INC_BC>() {
+  registers.set_BC(registers.get_BC() + 1);
+  incrementPC();
+}
 
-    // Store the contents of register A into the memory location specified by
-    // register pair HL, and simultaneously decrement the contents of HL.
-    case Instruction::Type::LD_HL_dec_A: {
-      memory->writeByte(registers.get_HL(), registers.A);
-      registers.set_HL(registers.get_HL() - 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Increment the contents of register B by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_B>() {
+  inc(registers.B);
+  incrementPC();
+}
 
-    // If the Z flag is 0, jump s8 steps from the current address stored in
-    // the program counter (PC). If not, the instruction following the current
-    // JP instruction is executed (as usual).
-    case Instruction::Type::JR_NZ_s8: {
-      if (!registers.F.zero) {
-        PC = signedAdd(PC, memory->readByte(PC + 1));
-        ++cycles;
-      }
-
-      cycles += 2;
-      setPC(PC + 2);
-      break;
-    }
+// Decrement the contents of register B by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_B>() {
+  dec(registers.B);
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register A.
-    case Instruction::Type::LD_A_d8: {
-      registers.A = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_d8>() {
+  registers.B = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::LD_A_A: {
-      registers.A = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Rotate the contents of register A to the left
+template <>
+void CPU::execute<Instruction::Type::RLCA>() {
+  rlc(registers.A);
+  registers.F.zero = false;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_A_B: {
-      registers.A = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Store the lower byte of stack pointer SP at the address specified by
+// the 16-bit immediate operand a16, and store the upper byte of SP at
+// address a16 + 1.
+template <>
+void CPU::execute<Instruction::Type::LD_a16_SP>() {
+  uint16_t a16 = memory->readWord(PC + 1);
+  memory->writeWord(a16, SP);
+  setPC(PC + 3);
+}
 
-    case Instruction::Type::LD_A_C: {
-      registers.A = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Add the contents of register pair BC to the contents of register pair
+// HL, and store the results in register pair HL.
+template <>
+void CPU::execute<Instruction::Type::ADD_HL_BC>() {
+  registers.set_HL(
+      addCompoundRegisters(registers.get_HL(), registers.get_BC()));
+  incrementPC();
+}
 
-    case Instruction::Type::LD_A_D: {
-      registers.A = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit contents of memory specified by register pair BC into
+// register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_BC>() {
+  registers.A = memory->readByte(registers.get_BC());
+  incrementPC();
+}
 
-    case Instruction::Type::LD_A_HL: {
-      registers.A = memory->readByte(registers.get_HL());
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register BC by 1
+template <>
+void CPU::execute<Instruction::Type::DEC_BC>() {
+  registers.set_BC(registers.get_BC() - 1);
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register C.
-    case Instruction::Type::LD_C_d8: {
-      registers.C = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+// Increment the contents of register C by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_C>() {
+  inc(registers.C);
+  incrementPC();
+}
 
-    // Store the contents of register A in the internal RAM, port register, or
-    // mode register at the address in the range 0xFF00-0xFFFF specified by
-    // register C.
-    case Instruction::Type::LD_mem_C_A: {
-      memory->writeByte(0xFF00 + registers.C, registers.A);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Decrement the contents of register C by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_C>() {
+  dec(registers.C);
+  incrementPC();
+}
 
-    // Increment the contents of register C by 1.
-    case Instruction::Type::INC_C: {
-      inc(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register C.
+template <>
+void CPU::execute<Instruction::Type::LD_C_d8>() {
+  registers.C = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    // Increment the contens of register pair BC by 1
-    case Instruction::Type::INC_BC: {
-      registers.set_BC(registers.get_BC() + 1);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Rotate the contents of register A to the right
+template <>
+void CPU::execute<Instruction::Type::RRCA>() {
+  rrc(registers.A);
+  registers.F.zero = false;
+  incrementPC();
+}
 
-    // Store the contents of register A in the memory location specified by
-    // register pair HL.
-    case Instruction::Type::LD_HL_A: {
-      memory->writeByte(registers.get_HL(), registers.A);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::STOP>() {
+  halted = true;
+  incrementPC();
+}
 
-    // Store the contents of register A in the internal RAM, port register, or
-    // mode register at the address in the range 0xFF00-0xFFFF specified by
-    // the 8-bit immediate operand a8.
-    case Instruction::Type::LD_a8_A: {
-      if (memory->readByte(PC + 1) == 0x50 && inBootRom) {
-        for (int i = 0; i <= 256; ++i) memory->writeByte(i, romData[i]);
-        inBootRom = false;
-      }
-
-      memory->writeByte(0xFF00 + memory->readByte(PC + 1), registers.A);
-      setPC(PC + 2);
-      cycles += 3;
-      break;
-    }
+// Load the 2 bytes of immediate data into register pair DE.
+template <>
+void CPU::execute<Instruction::Type::LD_DE_d16>() {
+  registers.set_DE(memory->readWord(PC + 1));
+  setPC(PC + 3);
+}
 
-    // Load the 2 bytes of immediate data into register pair DE.
-    case Instruction::Type::LD_DE_d16: {
-      registers.set_DE(memory->readWord(PC + 1));
-      setPC(PC + 3);
-      cycles += 3;
-      break;
-    }
+// Store the contents of register A in the memory location specified by
+// register pair DE.
+template <>
+void CPU::execute<Instruction::Type::LD_DE_A>() {
+  memory->writeByte(registers.get_DE(), registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::CP_A: {
-      cp(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register pair DE by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_DE>() {
+  registers.set_DE(registers.get_DE() + 1);
+  incrementPC();
+}
 
-    case Instruction::Type::CP_B: {
-      cp(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register D by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_D>() {
+  inc(registers.D);
+  incrementPC();
+}
 
-    case Instruction::Type::CP_C: {
-      cp(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register D by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_D>() {
+  dec(registers.D);
+  incrementPC();
+}
 
-    case Instruction::Type::CP_D: {
-      cp(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_d8>() {
+  registers.D = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::CP_E: {
-      cp(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Rotate the contents of register A to the left, through the carry (CY)
+// flag.
+template <>
+void CPU::execute<Instruction::Type::RLA>() {
+  rl(registers.A);
+  registers.F.zero = false;
+  incrementPC();
+}
 
-    case Instruction::Type::CP_H: {
-      cp(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Jump s8 steps from the current address in the program counter (PC). (Jump
+// relative.)
+template <>
+void CPU::execute<Instruction::Type::JR_s8>() {
+  PC = signedAdd(PC + 2, memory->readByte(PC + 1));
+}
 
-    case Instruction::Type::CP_L: {
-      cp(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Add the contents of register pair DE to the contents of register pair
+// HL, and store the results in register pair HL.
+template <>
+void CPU::execute<Instruction::Type::ADD_HL_DE>() {
+  registers.set_HL(
+      addCompoundRegisters(registers.get_HL(), registers.get_DE()));
+  incrementPC();
+}
 
-    case Instruction::Type::CP_HL: {
-      cp(memory->readByte(registers.get_HL()));
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit contents of memory specified by register pair DE into
+// register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_DE>() {
+  registers.A = memory->readByte(registers.get_DE());
+  incrementPC();
+}
 
-    case Instruction::Type::OR_A: {
-      or_(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register DE by 1
+template <>
+void CPU::execute<Instruction::Type::DEC_DE>() {
+  registers.set_DE(registers.get_DE() - 1);
+  incrementPC();
+}
 
-    case Instruction::Type::OR_B: {
-      or_(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register E by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_E>() {
+  inc(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::OR_C: {
-      or_(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register E by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_E>() {
+  dec(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::OR_D: {
-      or_(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_d8>() {
+  registers.E = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::OR_E: {
-      or_(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Rotate the contents of register A to the right, through the carry (CY)
+// flag.
+template <>
+void CPU::execute<Instruction::Type::RRA>() {
+  rr(registers.A);
+  registers.F.zero = false;
+  incrementPC();
+}
 
-    case Instruction::Type::OR_H: {
-      or_(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// If the Z flag is 0, jump s8 steps from the current address stored in
+// the program counter (PC). If not, the instruction following the current
+// JP instruction is executed (as usual).
+template <>
+void CPU::execute<Instruction::Type::JR_NZ_s8>() {
+  if (!registers.F.zero) {
+    PC = signedAdd(PC, memory->readByte(PC + 1));
+    ++cycles;
+  }
 
-    case Instruction::Type::OR_L: {
-      or_(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::OR_HL: {
-      or_(memory->readByte(registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Load the 2 bytes of immediate data into register pair HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_d16>() {
+  registers.set_HL(memory->readWord(PC + 1));
+  setPC(PC + 3);
+}
 
-    case Instruction::Type::XOR_d8: {
-      xor_(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+// Store the contents of register A into the memory location specified by
+// register pair HL, and simultaneously increment the contents of HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_inc__A>() {
+  memory->writeByte(registers.get_HL(), registers.A);
+  registers.set_HL(registers.get_HL() + 1);
+  incrementPC();
+}
 
-    case Instruction::Type::XOR_A: {
-      xor_(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register pair HL by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_HL>() {
+  registers.set_HL(registers.get_HL() + 1);
+  incrementPC();
+}
 
-    case Instruction::Type::XOR_B: {
-      xor_(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register H by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_H>() {
+  inc(registers.H);
+  incrementPC();
+}
 
-    case Instruction::Type::XOR_C: {
-      xor_(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register H by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_H>() {
+  dec(registers.H);
+  incrementPC();
+}
 
-    case Instruction::Type::XOR_D: {
-      xor_(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register H.
+template <>
+void CPU::execute<Instruction::Type::LD_H_d8>() {
+  registers.H = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::XOR_E: {
-      xor_(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
+// Adjust the accumulator (register A) to a binary-coded decimal (BCD)
+// number after BCD addition and subtraction operations.
+template <>
+void CPU::execute<Instruction::Type::DAA>() {
+  if (!registers.F.subtraction) {
+    if (registers.F.carry || registers.A > 0x99) {
+      registers.A += 0x60;
+      registers.F.carry = true;
     }
 
-    case Instruction::Type::XOR_H: {
-      xor_(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+    if (registers.F.halfCarry || (registers.A & 0x0f) > 0x09)
+      registers.A += 0x6;
 
-    case Instruction::Type::XOR_L: {
-      xor_(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+  } else {
+    if (registers.F.carry) registers.A -= 0x60;
+    if (registers.F.halfCarry) registers.A -= 0x6;
+  }
 
-    case Instruction::Type::XOR_HL: {
-      xor_(memory->readByte(registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+  registers.F.zero = registers.A == 0;
+  registers.F.halfCarry = false;
 
-    case Instruction::Type::AND_A: {
-      and_(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+  incrementPC();
+}
 
-    case Instruction::Type::AND_B: {
-      and_(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// If the Z flag is 1, jump s8 steps from the current address stored in the
+// program counter (PC). If not, the instruction following the current JP
+// instruction is executed (as usual).
+template <>
+void CPU::execute<Instruction::Type::JR_Z_s8>() {
+  if (registers.F.zero) {
+    PC += (int8_t)memory->readByte(PC + 1) + 2;
+    ++cycles;
+  } else {
+    setPC(PC + 2);
+  }
+}
 
-    case Instruction::Type::AND_C: {
-      and_(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Add the contents of register pair HL to the contents of register pair
+// HL, and store the results in register pair HL.
+template <>
+void CPU::execute<Instruction::Type::ADD_HL_HL>() {
+  registers.set_HL(
+      addCompoundRegisters(registers.get_HL(), registers.get_HL()));
+  incrementPC();
+}
 
-    case Instruction::Type::AND_D: {
-      and_(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of memory specified by register pair HL into register
+// A, and simultaneously increment the contents of HL.
+template <>
+void CPU::execute<Instruction::Type::LD_A_HL_inc_>() {
+  registers.A = memory->readByte(registers.get_HL());
+  registers.set_HL(registers.get_HL() + 1);
+  incrementPC();
+}
 
-    case Instruction::Type::AND_E: {
-      and_(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register HL by 1
+template <>
+void CPU::execute<Instruction::Type::DEC_HL>() {
+  registers.set_HL(registers.get_HL() - 1);
+  incrementPC();
+}
 
-    case Instruction::Type::AND_H: {
-      and_(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register L by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_L>() {
+  inc(registers.L);
+  incrementPC();
+}
 
-    case Instruction::Type::AND_L: {
-      and_(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register L by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_L>() {
+  dec(registers.L);
+  incrementPC();
+}
 
-    case Instruction::Type::AND_HL: {
-      and_(memory->readByte(registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_d8>() {
+  registers.L = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    // Load the 8-bit contents of memory specified by register pair DE into
-    // register A.
-    case Instruction::Type::LD_A_DE: {
-      registers.A = memory->readByte(registers.get_DE());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Flips all the bits in the 8-bit A register, and sets the N and H flags.
+template <>
+void CPU::execute<Instruction::Type::CPL>() {
+  registers.A = ~registers.A;
+  registers.F.subtraction = true;
+  registers.F.halfCarry = true;
+  incrementPC();
+}
 
-    // In memory, push the program counter PC value corresponding to the
-    // address following the CALL instruction to the 2 bytes following the
-    // byte specified by the current stack pointer SP. Then load the 16-bit
-    // immediate operand a16 into PC.
-    case Instruction::Type::CALL_a16: {
-      uint16_t a16 = memory->readWord(PC + 1);
-      push(PC + 3);
-      setPC(a16);
-      cycles += 6;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JR_NC_s8>() {
+  if (!registers.F.carry) {
+    PC = signedAdd(PC + 2, memory->readByte(PC + 1));
+    ++cycles;
+  } else {
+    setPC(PC + 2);
+  }
+}
 
-    case Instruction::Type::CALL_C_a16: {
-      if (registers.F.carry) {
-        uint16_t a16 = memory->readWord(PC + 1);
-        push(PC + 3);
-        setPC(a16);
-        cycles += 6;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+// Load the 2 bytes of immediate data into register pair SP.
+template <>
+void CPU::execute<Instruction::Type::LD_SP_d16>() {
+  SP = memory->readWord(PC + 1);
+  setPC(PC + 3);
+}
 
-    case Instruction::Type::CALL_NC_a16: {
-      if (!registers.F.carry) {
-        uint16_t a16 = memory->readWord(PC + 1);
-        push(PC + 3);
-        setPC(a16);
-        cycles += 6;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+// Store the contents of register A into the memory location specified by
+// register pair HL, and simultaneously decrement the contents of HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_dec_A>() {
+  memory->writeByte(registers.get_HL(), registers.A);
+  registers.set_HL(registers.get_HL() - 1);
+  incrementPC();
+}
 
-    case Instruction::Type::CALL_Z_a16: {
-      if (registers.F.zero) {
-        uint16_t a16 = memory->readWord(PC + 1);
-        push(PC + 3);
-        setPC(a16);
-        cycles += 6;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+// Increment the contents of register pair SP by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_SP>() {
+  ++SP;
+  incrementPC();
+}
 
-    case Instruction::Type::CALL_NZ_a16: {
-      if (!registers.F.zero) {
-        uint16_t a16 = memory->readWord(PC + 1);
-        push(PC + 3);
-        setPC(a16);
-        cycles += 6;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+// Increment the contents of memory specified by register pair HL by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_mem_HL>() {
+  auto data = memory->readByte(registers.get_HL());
+  registers.F.halfCarry = (data & 0xF) == 0xF;
+  ++data;
+  registers.F.zero = data == 0;
+  registers.F.subtraction = false;
+  memory->writeByte(registers.get_HL(), data);
 
-    // Flip the carry flag CY.
-    case Instruction::Type::CCF: {
-      registers.F.carry = !registers.F.carry;
-      registers.F.subtraction = false;
-      registers.F.halfCarry = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+  incrementPC();
+}
 
-    // Load the contents of register A into register B.
-    case Instruction::Type::LD_B_A: {
-      registers.B = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the conents of memory specified by register pair HL by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_mem_HL>() {
+  uint8_t data = memory->readByte(registers.get_HL());
+  --data;
+  registers.F.zero = data == 0;
+  registers.F.subtraction = true;
+  registers.F.halfCarry = (data & 0xF) == 0xF;
+  memory->writeByte(registers.get_HL(), data);
 
-    // Load the contents of register B into register B.
-    case Instruction::Type::LD_B_B: {
-      registers.B = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+  incrementPC();
+}
 
-    // Load the contents of register C into register B.
-    case Instruction::Type::LD_B_C: {
-      registers.B = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Store the contents of 8-bit immediate operand d8 in the memory location
+// specified by register pair HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_d8>() {
+  memory->writeByte(registers.get_HL(), memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    // Load the contents of register D into register B.
-    case Instruction::Type::LD_B_D: {
-      registers.B = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Sets the carry flag, and clears the N and H flags.
+template <>
+void CPU::execute<Instruction::Type::SCF>() {
+  registers.F.carry = true;
+  registers.F.halfCarry = false;
+  registers.F.subtraction = false;
+  incrementPC();
+}
 
-    // Load the contents of register E into register B.
-    case Instruction::Type::LD_B_E: {
-      registers.B = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JR_C_s8>() {
+  if (registers.F.carry) {
+    PC = signedAdd(PC + 2, memory->readByte(PC + 1));
+    ++cycles;
+  } else {
+    setPC(PC + 2);
+  }
+}
 
-    // Load the contents of register H into register B.
-    case Instruction::Type::LD_B_H: {
-      registers.B = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Add the contents of register SP to the contents of register pair HL,
+// and store the results in register pair HL.
+template <>
+void CPU::execute<Instruction::Type::ADD_HL_SP>() {
+  registers.set_HL(addCompoundRegisters(registers.get_HL(), SP));
+  incrementPC();
+}
 
-    // Load the contents of register L into register B.
-    case Instruction::Type::LD_B_L: {
-      registers.B = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of memory specified by register pair HL into register
+// A, and simultaneously decrement the contents of HL.
+template <>
+void CPU::execute<Instruction::Type::LD_A_HL_dec_>() {
+  registers.A = memory->readByte(registers.get_HL());
+  registers.set_HL(registers.get_HL() - 1);
+  incrementPC();
+}
 
-    // Load the contents of register A into register C.
-    case Instruction::Type::LD_C_A: {
-      registers.C = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register SP by 1
+template <>
+void CPU::execute<Instruction::Type::DEC_SP>() {
+  --SP;
+  incrementPC();
+}
 
-    // Load the contents of register B into register B.
-    case Instruction::Type::LD_C_B: {
-      registers.C = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Increment the contents of register A by 1.
+template <>
+void CPU::execute<Instruction::Type::INC_A>() {
+  inc(registers.A);
+  incrementPC();
+}
 
-    // Load the contents of register C into register B.
-    case Instruction::Type::LD_C_C: {
-      registers.C = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Decrement the contents of register A by 1.
+template <>
+void CPU::execute<Instruction::Type::DEC_A>() {
+  dec(registers.A);
+  incrementPC();
+}
 
-    // Load the contents of register D into register B.
-    case Instruction::Type::LD_C_D: {
-      registers.C = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit immediate operand d8 into register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_d8>() {
+  registers.A = memory->readByte(PC + 1);
+  setPC(PC + 2);
+}
 
-    // Load the contents of register E into register B.
-    case Instruction::Type::LD_C_E: {
-      registers.C = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Flip the carry flag CY.
+template <>
+void CPU::execute<Instruction::Type::CCF>() {
+  registers.F.carry = !registers.F.carry;
+  registers.F.subtraction = false;
+  registers.F.halfCarry = false;
+  incrementPC();
+}
 
-    // Load the contents of register H into register B.
-    case Instruction::Type::LD_C_H: {
-      registers.C = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register B into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_B>() {
+  registers.B = registers.B;
+  incrementPC();
+}
 
-    // Load the contents of register L into register B.
-    case Instruction::Type::LD_C_L: {
-      registers.C = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register C into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_C>() {
+  registers.B = registers.C;
+  incrementPC();
+}
 
-    // Load the contents of register A into register D.
-    case Instruction::Type::LD_D_A: {
-      registers.D = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register D into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_D>() {
+  registers.B = registers.D;
+  incrementPC();
+}
 
-    // Load the contents of register B into register D.
-    case Instruction::Type::LD_D_B: {
-      registers.D = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register E into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_E>() {
+  registers.B = registers.E;
+  incrementPC();
+}
 
-    // Load the contents of register C into register D.
-    case Instruction::Type::LD_D_C: {
-      registers.D = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register H into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_H>() {
+  registers.B = registers.H;
+  incrementPC();
+}
 
-    // Load the contents of register D into register D.
-    case Instruction::Type::LD_D_D: {
-      registers.D = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register L into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_L>() {
+  registers.B = registers.L;
+  incrementPC();
+}
 
-    // Load the contents of register E into register D.
-    case Instruction::Type::LD_D_E: {
-      registers.D = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit contents of memory specified by register pair HL into
+// register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_HL>() {
+  registers.B = memory->readByte(registers.get_HL());
+  incrementPC();
+}
 
-    // Load the contents of register H into register D.
-    case Instruction::Type::LD_D_H: {
-      registers.D = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register A into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_B_A>() {
+  registers.B = registers.A;
+  incrementPC();
+}
 
-    // Load the contents of register L into register D.
-    case Instruction::Type::LD_D_L: {
-      registers.D = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register B into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_B>() {
+  registers.C = registers.B;
+  incrementPC();
+}
 
-    // Load the contents of register A into register E.
-    case Instruction::Type::LD_E_A: {
-      registers.E = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register C into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_C>() {
+  registers.C = registers.C;
+  incrementPC();
+}
 
-    // Load the contents of register B into register E.
-    case Instruction::Type::LD_E_B: {
-      registers.E = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register D into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_D>() {
+  registers.C = registers.D;
+  incrementPC();
+}
 
-    // Load the contents of register C into register E.
-    case Instruction::Type::LD_E_C: {
-      registers.E = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register E into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_E>() {
+  registers.C = registers.E;
+  incrementPC();
+}
 
-    // Load the contents of register D into register E.
-    case Instruction::Type::LD_E_D: {
-      registers.E = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register H into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_H>() {
+  registers.C = registers.H;
+  incrementPC();
+}
 
-    // Load the contents of register E into register E.
-    case Instruction::Type::LD_E_E: {
-      registers.E = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register L into register B.
+template <>
+void CPU::execute<Instruction::Type::LD_C_L>() {
+  registers.C = registers.L;
+  incrementPC();
+}
 
-    // Load the contents of register H into register E.
-    case Instruction::Type::LD_E_H: {
-      registers.E = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit contents of memory specified by register pair HL into
+// register C.
+template <>
+void CPU::execute<Instruction::Type::LD_C_HL>() {
+  registers.C = memory->readByte(registers.get_HL());
+  incrementPC();
+}
 
-    // Load the contents of register L into register E.
-    case Instruction::Type::LD_E_L: {
-      registers.E = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register A into register C.
+template <>
+void CPU::execute<Instruction::Type::LD_C_A>() {
+  registers.C = registers.A;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_H_C: {
-      registers.H = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register B into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_B>() {
+  registers.D = registers.B;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_H_D: {
-      registers.H = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register C into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_C>() {
+  registers.D = registers.C;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_H_E: {
-      registers.H = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register D into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_D>() {
+  registers.D = registers.D;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_H_L: {
-      registers.H = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register E into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_E>() {
+  registers.D = registers.E;
+  incrementPC();
+}
+
+// Load the contents of register H into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_H>() {
+  registers.D = registers.H;
+  incrementPC();
+}
+
+// Load the contents of register L into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_L>() {
+  registers.D = registers.L;
+  incrementPC();
+}
+
+// Load the 8-bit contents of memory specified by register pair HL into
+// register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_HL>() {
+  registers.D = memory->readByte(registers.get_HL());
+  incrementPC();
+}
+
+// Load the contents of register A into register D.
+template <>
+void CPU::execute<Instruction::Type::LD_D_A>() {
+  registers.D = registers.A;
+  incrementPC();
+}
+
+// Load the contents of register B into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_B>() {
+  registers.E = registers.B;
+  incrementPC();
+}
+
+// Load the contents of register C into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_C>() {
+  registers.E = registers.C;
+  incrementPC();
+}
+
+// Load the contents of register D into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_D>() {
+  registers.E = registers.D;
+  incrementPC();
+}
+
+// Load the contents of register E into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_E>() {
+  registers.E = registers.E;
+  incrementPC();
+}
+
+// Load the contents of register H into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_H>() {
+  registers.E = registers.H;
+  incrementPC();
+}
+
+// Load the contents of register L into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_L>() {
+  registers.E = registers.L;
+  incrementPC();
+}
+
+// Load the 8-bit contents of memory specified by register pair HL into
+// register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_HL>() {
+  registers.E = memory->readByte(registers.get_HL());
+  incrementPC();
+}
+
+// Load the contents of register A into register E.
+template <>
+void CPU::execute<Instruction::Type::LD_E_A>() {
+  registers.E = registers.A;
+  incrementPC();
+}
+
+// Load the contents of register B into register H.
+template <>
+void CPU::execute<Instruction::Type::LD_H_B>() {
+  registers.H = registers.B;
+  incrementPC();
+}
+
+template <>
+void CPU::execute<Instruction::Type::LD_H_C>() {
+  registers.H = registers.C;
+  incrementPC();
+}
+
+template <>
+void CPU::execute<Instruction::Type::LD_H_D>() {
+  registers.H = registers.D;
+  incrementPC();
+}
+
+template <>
+void CPU::execute<Instruction::Type::LD_H_E>() {
+  registers.H = registers.E;
+  incrementPC();
+}
+
+template <>
+void CPU::execute<Instruction::Type::LD_H_H>() {
+  registers.H = registers.H;
+  incrementPC();
+}
+
+template <>
+void CPU::execute<Instruction::Type::LD_H_L>() {
+  registers.H = registers.L;
+  incrementPC();
+}
+
+// Load the 8-bit contents of memory specified by register pair HL into
+// register H.
+template <>
+void CPU::execute<Instruction::Type::LD_H_HL>() {
+  registers.H = memory->readByte(registers.get_HL());
+  incrementPC();
+}
+
+// Load the contents of register A into register H.
+template <>
+void CPU::execute<Instruction::Type::LD_H_A>() {
+  registers.H = registers.A;
+  incrementPC();
+}
+
+// Load the contents of register B into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_B>() {
+  registers.L = registers.B;
+  incrementPC();
+}
 
-    case Instruction::Type::LD_H_H: {
-      registers.H = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register C into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_C>() {
+  registers.L = registers.C;
+  incrementPC();
+}
 
-    // Load the contents of register A into register L.
-    case Instruction::Type::LD_L_A: {
-      registers.L = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register D into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_D>() {
+  registers.L = registers.D;
+  incrementPC();
+}
 
-    // Load the contents of register B into register L.
-    case Instruction::Type::LD_L_B: {
-      registers.L = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register E into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_E>() {
+  registers.L = registers.E;
+  incrementPC();
+}
 
-    // Load the contents of register C into register L.
-    case Instruction::Type::LD_L_C: {
-      registers.L = registers.C;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register H into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_H>() {
+  registers.L = registers.H;
+  incrementPC();
+}
 
-    // Load the contents of register D into register L.
-    case Instruction::Type::LD_L_D: {
-      registers.L = registers.D;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register L into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_L>() {
+  registers.L = registers.L;
+  incrementPC();
+}
 
-    // Load the contents of register E into register L.
-    case Instruction::Type::LD_L_E: {
-      registers.L = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 8-bit contents of memory specified by register pair HL into
+// register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_HL>() {
+  registers.L = memory->readByte(registers.get_HL());
+  incrementPC();
+}
 
-    // Load the contents of register H into register L.
-    case Instruction::Type::LD_L_H: {
-      registers.L = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register A into register L.
+template <>
+void CPU::execute<Instruction::Type::LD_L_A>() {
+  registers.L = registers.A;
+  incrementPC();
+}
 
-    // Load the contents of register L into register L.
-    case Instruction::Type::LD_L_L: {
-      registers.L = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_HL_B>() {
+  memory->writeByte(registers.get_HL(), registers.B);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register B.
-    case Instruction::Type::LD_B_HL: {
-      registers.B = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_HL_C>() {
+  memory->writeByte(registers.get_HL(), registers.C);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register C.
-    case Instruction::Type::LD_C_HL: {
-      registers.C = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_HL_D>() {
+  memory->writeByte(registers.get_HL(), registers.D);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register D.
-    case Instruction::Type::LD_D_HL: {
-      registers.D = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_HL_E>() {
+  memory->writeByte(registers.get_HL(), registers.E);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register E.
-    case Instruction::Type::LD_E_HL: {
-      registers.E = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_HL_H>() {
+  memory->writeByte(registers.get_HL(), registers.H);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register H.
-    case Instruction::Type::LD_H_HL: {
-      registers.H = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+  // ---
+template <>
+void CPU::execute<Instruction::Type::LD_HL_L>() {
+  memory->writeByte(registers.get_HL(), registers.L);
+  incrementPC();
+}
 
-    // Load the 8-bit contents of memory specified by register pair HL into
-    // register L.
-    case Instruction::Type::LD_L_HL: {
-      registers.L = memory->readByte(registers.get_HL());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::HALT>() {
+  halted = true;
+  incrementPC();
+}
 
-    // If the CY flag is 0, control is returned to the source program by
-    // popping from the memory stack the program counter PC value that was
-    // pushed to the stack when the subroutine was called.
-    case Instruction::Type::RET_NC: {
-      if (!registers.F.carry) {
-        PC = pop();
-        cycles += 5;
-      } else {
-        incrementPC();
-        cycles += 2;
-      }
-      break;
-    }
+// Store the contents of register A in the memory location specified by
+// register pair HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_A>() {
+  memory->writeByte(registers.get_HL(), registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::RET_C: {
-      if (registers.F.carry) {
-        PC = pop();
-        cycles += 5;
-      } else {
-        incrementPC();
-        cycles += 2;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_B>() {
+  registers.A = registers.B;
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register B.
-    case Instruction::Type::LD_B_d8: {
-      registers.B = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_C>() {
+  registers.A = registers.C;
+  incrementPC();
+}
 
-    // Push the contents of register pair BC onto the memory stack
-    case Instruction::Type::PUSH_BC: {
-      push(registers.get_BC());
-      incrementPC();
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_D>() {
+  registers.A = registers.D;
+  incrementPC();
+}
 
-    case Instruction::Type::PUSH_DE: {
-      push(registers.get_DE());
-      incrementPC();
-      cycles += 4;
-      break;
-    }
+// Load the contents of register E into register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_E>() {
+  registers.A = registers.E;
+  incrementPC();
+}
 
-    // Rotate the contents of register A to the left, through the carry (CY)
-    // flag.
-    case Instruction::Type::RLA: {
-      rl(registers.A);
-      registers.F.zero = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the contents of register H into register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_H>() {
+  registers.A = registers.H;
+  incrementPC();
+}
 
-    // Pop the contents from the memory stack into register pair BC.
-    case Instruction::Type::POP_BC: {
-      registers.set_BC(pop());
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+// Load the contents of register L into register A.
+template <>
+void CPU::execute<Instruction::Type::LD_A_L>() {
+  registers.A = registers.L;
+  incrementPC();
+}
 
-    // Decrement the contents of register B by 1.
-    case Instruction::Type::DEC_B: {
-      dec(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_HL>() {
+  registers.A = memory->readByte(registers.get_HL());
+  incrementPC();
+}
 
-    // Store the contents of register A into the memory location specified by
-    // register pair HL, and simultaneously increment the contents of HL.
-    case Instruction::Type::LD_HL_inc__A: {
-      memory->writeByte(registers.get_HL(), registers.A);
-      registers.set_HL(registers.get_HL() + 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_A>() {
+  registers.A = registers.A;
+  incrementPC();
+}
 
-    // Load the contents of memory specified by register pair HL into register
-    // A, and simultaneously increment the contents of HL.
-    case Instruction::Type::LD_A_HL_inc_: {
-      registers.A = memory->readByte(registers.get_HL());
-      registers.set_HL(registers.get_HL() + 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_B>() {
+  add(registers.B);
+  incrementPC();
+}
 
-    // Increment the contents of register pair HL by 1.
-    case Instruction::Type::INC_HL: {
-      registers.set_HL(registers.get_HL() + 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_C>() {
+  add(registers.C);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_B: {
-      memory->writeByte(registers.get_HL(), registers.B);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_D>() {
+  add(registers.D);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_C: {
-      memory->writeByte(registers.get_HL(), registers.C);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_E>() {
+  add(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_D: {
-      memory->writeByte(registers.get_HL(), registers.D);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_H>() {
+  add(registers.H);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_E: {
-      memory->writeByte(registers.get_HL(), registers.E);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_L>() {
+  add(registers.L);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_H: {
-      memory->writeByte(registers.get_HL(), registers.H);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Add the contents of memory specified by register pair HL to the
+// contents of register A, and store the results in register A.
+template <>
+void CPU::execute<Instruction::Type::ADD_A_HL>() {
+  add(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-      // ---
+template <>
+void CPU::execute<Instruction::Type::ADD_A_A>() {
+  add(registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::LD_HL_L: {
-      memory->writeByte(registers.get_HL(), registers.L);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_B>() {
+  adc(registers.B);
+  incrementPC();
+}
 
-    // Pop from the memory stack the program counter PC value pushed when the
-    // subroutine was called, returning control to the source program.
-    case Instruction::Type::RET: {
-      PC = pop();
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_C>() {
+  adc(registers.C);
+  incrementPC();
+}
 
-    // Increment the contents of register pair DE by 1.
-    case Instruction::Type::INC_DE: {
-      registers.set_DE(registers.get_DE() + 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_D>() {
+  adc(registers.D);
+  incrementPC();
+}
 
-    // Load the contents of register E into register A.
-    case Instruction::Type::LD_A_E: {
-      registers.A = registers.E;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_E>() {
+  adc(registers.E);
+  incrementPC();
+}
 
-    // Compare the contents of register A and the contents of the 8-bit
-    // immediate operand d8 by calculating A - d8, and set the Z flag if they
-    // are equal.
-    case Instruction::Type::CP_d8: {
-      cp(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_H>() {
+  adc(registers.H);
+  incrementPC();
+}
 
-    // Store the contents of register A in the internal RAM or register
-    // specified by the 16-bit immediate operand a16.
-    case Instruction::Type::LD_a16_A: {
-      memory->writeByte(memory->readWord(PC + 1), registers.A);
-      setPC(PC + 3);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_L>() {
+  adc(registers.L);
+  incrementPC();
+}
 
-    // Decrement the contents of register A by 1.
-    case Instruction::Type::DEC_A: {
-      dec(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_HL>() {
+  adc(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    // If the Z flag is 1, jump s8 steps from the current address stored in the
-    // program counter (PC). If not, the instruction following the current JP
-    // instruction is executed (as usual).
-    case Instruction::Type::JR_Z_s8: {
-      if (registers.F.zero) {
-        PC += (int8_t)memory->readByte(PC + 1) + 2;
-        cycles += 3;
-      } else {
-        setPC(PC + 2);
-        cycles += 2;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_A>() {
+  adc(registers.A);
+  incrementPC();
+}
 
-    // Decrement the contents of register C by 1.
-    case Instruction::Type::DEC_C: {
-      dec(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_B>() {
+  sub(registers.B);
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register L.
-    case Instruction::Type::LD_L_d8: {
-      registers.L = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_C>() {
+  sub(registers.C);
+  incrementPC();
+}
 
-    // Jump s8 steps from the current address in the program counter (PC). (Jump
-    // relative.)
-    case Instruction::Type::JR_s8: {
-      PC = signedAdd(PC + 2, memory->readByte(PC + 1));
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_D>() {
+  sub(registers.D);
+  incrementPC();
+}
 
-    // Rotate the contents of register A to the right, through the carry (CY)
-    // flag.
-    case Instruction::Type::RRA: {
-      rr(registers.A);
-      registers.F.zero = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_E>() {
+  sub(registers.E);
+  incrementPC();
+}
 
-    // Flips all the bits in the 8-bit A register, and sets the N and H flags.
-    case Instruction::Type::CPL: {
-      registers.A = ~registers.A;
-      registers.F.subtraction = true;
-      registers.F.halfCarry = true;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_H>() {
+  sub(registers.H);
+  incrementPC();
+}
 
-    // Sets the carry flag, and clears the N and H flags.
-    case Instruction::Type::SCF: {
-      registers.F.carry = true;
-      registers.F.halfCarry = false;
-      registers.F.subtraction = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_L>() {
+  sub(registers.L);
+  incrementPC();
+}
 
-    // Adjust the accumulator (register A) to a binary-coded decimal (BCD)
-    // number after BCD addition and subtraction operations.
-    case Instruction::Type::DAA: {
-      if (!registers.F.subtraction) {
-        if (registers.F.carry || registers.A > 0x99) {
-          registers.A += 0x60;
-          registers.F.carry = true;
-        }
+template <>
+void CPU::execute<Instruction::Type::SUB_HL>() {
+  sub(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-        if (registers.F.halfCarry || (registers.A & 0x0f) > 0x09)
-          registers.A += 0x6;
+template <>
+void CPU::execute<Instruction::Type::SUB_A>() {
+  sub(registers.A);
+  incrementPC();
+}
 
-      } else {
-        if (registers.F.carry) registers.A -= 0x60;
-        if (registers.F.halfCarry) registers.A -= 0x6;
-      }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_B>() {
+  sbc(registers.B);
+  incrementPC();
+}
 
-      registers.F.zero = registers.A == 0;
-      registers.F.halfCarry = false;
+template <>
+void CPU::execute<Instruction::Type::SBC_A_C>() {
+  sbc(registers.C);
+  incrementPC();
+}
 
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_D>() {
+  sbc(registers.D);
+  incrementPC();
+}
 
-    // Load the contents of memory specified by register pair HL into register
-    // A, and simultaneously decrement the contents of HL.
-    case Instruction::Type::LD_A_HL_dec_: {
-      registers.A = memory->readByte(registers.get_HL());
-      registers.set_HL(registers.get_HL() - 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_E>() {
+  sbc(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::JR_C_s8: {
-      if (registers.F.carry) {
-        PC = signedAdd(PC + 2, memory->readByte(PC + 1));
-        cycles += 3;
-      } else {
-        setPC(PC + 2);
-        cycles += 2;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_H>() {
+  sbc(registers.H);
+  incrementPC();
+}
 
-    case Instruction::Type::JR_NC_s8: {
-      if (!registers.F.carry) {
-        PC = signedAdd(PC + 2, memory->readByte(PC + 1));
-        cycles += 3;
-      } else {
-        setPC(PC + 2);
-        cycles += 2;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_L>() {
+  sbc(registers.L);
+  incrementPC();
+}
 
-    // Load the contents of register A into register H.
-    case Instruction::Type::LD_H_A: {
-      registers.H = registers.A;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_HL>() {
+  sbc(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    // Load the contents of register B into register H.
-    case Instruction::Type::LD_H_B: {
-      registers.H = registers.B;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_A>() {
+  sbc(registers.A);
+  incrementPC();
+}
 
-    // Increment the contents of register B by 1.
-    case Instruction::Type::INC_B: {
-      inc(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_B>() {
+  and_(registers.B);
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register E.
-    case Instruction::Type::LD_E_d8: {
-      registers.E = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_C>() {
+  and_(registers.C);
+  incrementPC();
+}
 
-    // Load into register A the contents of the internal RAM, port register,
-    // or mode register at the address in the range 0xFF00-0xFFFF specified by
-    // the 8-bit immediate operand a8.
-    case Instruction::Type::LD_A_a8: {
-      registers.A =
-          memory->readByte(0xFF00 + (uint16_t)memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_D>() {
+  and_(registers.D);
+  incrementPC();
+}
 
-    // Decrement the contents of register E by 1.
-    case Instruction::Type::DEC_E: {
-      dec(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_E>() {
+  and_(registers.E);
+  incrementPC();
+}
 
-    // Decrement the contents of register H by 1.
-    case Instruction::Type::DEC_H: {
-      dec(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_H>() {
+  and_(registers.H);
+  incrementPC();
+}
 
-    // Decrement the contents of register L by 1.
-    case Instruction::Type::DEC_L: {
-      dec(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_L>() {
+  and_(registers.L);
+  incrementPC();
+}
 
-    // Increment the contents of register H by 1.
-    case Instruction::Type::INC_H: {
-      inc(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_HL>() {
+  and_(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    // Load the contents of register H into register A.
-    case Instruction::Type::LD_A_H: {
-      registers.A = registers.H;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::AND_A>() {
+  and_(registers.A);
+  incrementPC();
+}
 
-    // Decrement the contents of register D by 1.
-    case Instruction::Type::DEC_D: {
-      dec(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_B>() {
+  xor_(registers.B);
+  incrementPC();
+}
 
-    // Load the 8-bit immediate operand d8 into register D.
-    case Instruction::Type::LD_D_d8: {
-      registers.D = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_C>() {
+  xor_(registers.C);
+  incrementPC();
+}
 
-    // Load the 2 bytes of immediate data into register pair BC.
-    case Instruction::Type::LD_BC_d16: {
-      registers.set_BC(memory->readWord(PC + 1));
-      setPC(PC + 3);
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_D>() {
+  xor_(registers.D);
+  incrementPC();
+}
 
-    // Load the contents of register L into register A.
-    case Instruction::Type::LD_A_L: {
-      registers.A = registers.L;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_E>() {
+  xor_(registers.E);
+  incrementPC();
+}
 
-    // Push the contents of register pair AF onto the memory stack
-    case Instruction::Type::PUSH_AF: {
-      push(registers.get_AF());
-      incrementPC();
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_H>() {
+  xor_(registers.H);
+  incrementPC();
+}
 
-    // Add the contents of memory specified by register pair HL to the
-    // contents of register A, and store the results in register A.
-    case Instruction::Type::ADD_A_HL: {
-      add(memory->readByte(registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_L>() {
+  xor_(registers.L);
+  incrementPC();
+}
 
-    // Add the contents of register pair DE to the contents of register pair
-    // HL, and store the results in register pair HL.
-    case Instruction::Type::ADD_HL_DE: {
-      registers.set_HL(
-          addCompoundRegisters(registers.get_HL(), registers.get_DE()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_HL>() {
+  xor_(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    // Add the contents of register pair BC to the contents of register pair
-    // HL, and store the results in register pair HL.
-    case Instruction::Type::ADD_HL_BC: {
-      registers.set_HL(
-          addCompoundRegisters(registers.get_HL(), registers.get_BC()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_A>() {
+  xor_(registers.A);
+  incrementPC();
+}
 
-    // Add the contents of register pair HL to the contents of register pair
-    // HL, and store the results in register pair HL.
-    case Instruction::Type::ADD_HL_HL: {
-      registers.set_HL(
-          addCompoundRegisters(registers.get_HL(), registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_B>() {
+  or_(registers.B);
+  incrementPC();
+}
 
-    // Add the contents of register SP to the contents of register pair HL,
-    // and store the results in register pair HL.
-    case Instruction::Type::ADD_HL_SP: {
-      registers.set_HL(addCompoundRegisters(registers.get_HL(), SP));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_C>() {
+  or_(registers.C);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_0: {
-      rst(0x00);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_D>() {
+  or_(registers.D);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_1: {
-      rst(0x08);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_E>() {
+  or_(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_2: {
-      rst(0x10);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_H>() {
+  or_(registers.H);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_3: {
-      rst(0x18);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_L>() {
+  or_(registers.L);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_4: {
-      rst(0x20);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_HL>() {
+  or_(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    case Instruction::Type::RST_5: {
-      rst(0x28);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_A>() {
+  or_(registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_6: {
-      rst(0x30);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_B>() {
+  cp(registers.B);
+  incrementPC();
+}
 
-    case Instruction::Type::RST_7: {
-      rst(0x38);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_C>() {
+  cp(registers.C);
+  incrementPC();
+}
 
-    case Instruction::Type::ADD_A_d8: {
-      add(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_D>() {
+  cp(registers.D);
+  incrementPC();
+}
 
-    case Instruction::Type::ADC_A_d8: {
-      adc(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_E>() {
+  cp(registers.E);
+  incrementPC();
+}
 
-    case Instruction::Type::SUB_d8: {
-      sub(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_H>() {
+  cp(registers.H);
+  incrementPC();
+}
 
-    // Store the lower byte of stack pointer SP at the address specified by
-    // the 16-bit immediate operand a16, and store the upper byte of SP at
-    // address a16 + 1.
-    case Instruction::Type::LD_a16_SP: {
-      uint16_t a16 = memory->readWord(PC + 1);
-      memory->writeWord(a16, SP);
-      setPC(PC + 3);
-      cycles += 5;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_L>() {
+  cp(registers.L);
+  incrementPC();
+}
 
-    // Load the 16-bit immediate operand a16 into the program counter (PC).
-    // a16 specifies the address of the subsequently executed instruction.
-    case Instruction::Type::JP_a16: {
-      PC = memory->readWord(PC + 1);
-      cycles += 4;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_HL>() {
+  cp(memory->readByte(registers.get_HL()));
+  incrementPC();
+}
 
-    case Instruction::Type::JP_C_a16: {
-      if (registers.F.carry) {
-        PC = memory->readWord(PC + 1);
-        cycles += 4;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CP_A>() {
+  cp(registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::JP_NC_a16: {
-      if (!registers.F.carry) {
-        PC = memory->readWord(PC + 1);
-        cycles += 4;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RET_NZ>() {
+  if (!registers.F.zero) {
+    PC = pop();
+    cycles += 3;
+  } else {
+    incrementPC();
+  }
+}
 
-    case Instruction::Type::JP_Z_a16: {
-      if (registers.F.zero) {
-        PC = memory->readWord(PC + 1);
-        cycles += 4;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+// Pop the contents from the memory stack into register pair BC.
+template <>
+void CPU::execute<Instruction::Type::POP_BC>() {
+  registers.set_BC(pop());
+  incrementPC();
+}
 
-    case Instruction::Type::JP_NZ_a16: {
-      if (!registers.F.zero) {
-        PC = memory->readWord(PC + 1);
-        cycles += 4;
-      } else {
-        setPC(PC + 3);
-        cycles += 3;
-      }
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JP_NZ_a16>() {
+  if (!registers.F.zero) {
+    PC = memory->readWord(PC + 1);
+    ++cycles;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Reset the interrupt master enable (IME) flag and prohibit maskable
-    // interrupts.
-    case Instruction::Type::DI: {
-      IME = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load the 16-bit immediate operand a16 into the program counter (PC).
+// a16 specifies the address of the subsequently executed instruction.
+template <>
+void CPU::execute<Instruction::Type::JP_a16>() {
+  PC = memory->readWord(PC + 1);
+}
 
-    case Instruction::Type::EI: {
-      IME = true;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CALL_NZ_a16>() {
+  if (!registers.F.zero) {
+    uint16_t a16 = memory->readWord(PC + 1);
+    push(PC + 3);
+    setPC(a16);
+    cycles += 3;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Push the contents of register pair HL onto the memory stack.
-    case Instruction::Type::PUSH_HL: {
-      push(registers.get_HL());
-      incrementPC();
-      cycles += 4;
-      break;
-    }
+// Push the contents of register pair BC onto the memory stack
+template <>
+void CPU::execute<Instruction::Type::PUSH_BC>() {
+  push(registers.get_BC());
+  incrementPC();
+}
 
-    // Pop the contents from the memory stack into register pair into register
-    // pair HL
-    case Instruction::Type::POP_HL: {
-      registers.set_HL(pop());
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_A_d8>() {
+  add(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    // Pop the contents from the memory stack into register pair into register
-    // pair AF
-    case Instruction::Type::POP_AF: {
-      registers.set_AF(pop());
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_0>() {
+  rst(0x00);
+}
 
-    // Pop the contents from the memory stack into register pair into register
-    // pair AF
-    case Instruction::Type::POP_DE: {
-      registers.set_DE(pop());
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RET_Z>() {
+  if (registers.F.zero) {
+    PC = pop();
+    cycles += 3;
+  } else {
+    incrementPC();
+  }
+}
 
-    // Load into register A the contents of the internal RAM or register
-    // specified by the 16-bit immediate operand a16.
-    case Instruction::Type::LD_A_a16: {
-      registers.A = memory->readByte(memory->readWord(PC + 1));
-      setPC(PC + 3);
-      cycles += 4;
-      break;
-    }
+// Pop from the memory stack the program counter PC value pushed when the
+// subroutine was called, returning control to the source program.
+template <>
+void CPU::execute<Instruction::Type::RET>() {
+  PC = pop();
+}
 
-    // Load the 8-bit contents of memory specified by register pair BC into
-    // register A.
-    case Instruction::Type::LD_A_BC: {
-      registers.A = memory->readByte(registers.get_BC());
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JP_Z_a16>() {
+  if (registers.F.zero) {
+    PC = memory->readWord(PC + 1);
+    ++cycles;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Take the logical AND for each bit of the contents of 8-bit immediate
-    // operand d8 and the contents of register A, and store the results in
-    // register A.
-    case Instruction::Type::AND_d8: {
-      and_(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CALL_Z_a16>() {
+  if (registers.F.zero) {
+    uint16_t a16 = memory->readWord(PC + 1);
+    push(PC + 3);
+    setPC(a16);
+    cycles += 3;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Store the contents of register A in the memory location specified by
-    // register pair BC.
-    case Instruction::Type::LD_BC_A: {
-      memory->writeByte(registers.get_BC(), registers.A);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// In memory, push the program counter PC value corresponding to the
+// address following the CALL instruction to the 2 bytes following the
+// byte specified by the current stack pointer SP. Then load the 16-bit
+// immediate operand a16 into PC.
+template <>
+void CPU::execute<Instruction::Type::CALL_a16>() {
+  uint16_t a16 = memory->readWord(PC + 1);
+  push(PC + 3);
+  setPC(a16);
+}
 
-    // Increment the contents of register pair SP by 1.
-    case Instruction::Type::INC_SP: {
-      ++SP;
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADC_A_d8>() {
+  adc(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    // Increment the contents of register D by 1.
-    case Instruction::Type::INC_D: {
-      inc(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_1>() {
+  rst(0x08);
+}
 
-    // Increment the contents of register E by 1.
-    case Instruction::Type::INC_E: {
-      inc(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// If the CY flag is 0, control is returned to the source program by
+// popping from the memory stack the program counter PC value that was
+// pushed to the stack when the subroutine was called.
+template <>
+void CPU::execute<Instruction::Type::RET_NC>() {
+  if (!registers.F.carry) {
+    PC = pop();
+    cycles += 3;
+  } else {
+    incrementPC();
+  }
+}
 
-    // Increment the contents of register L by 1.
-    case Instruction::Type::INC_L: {
-      inc(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Pop the contents from the memory stack into register pair into register
+// pair AF
+template <>
+void CPU::execute<Instruction::Type::POP_DE>() {
+  registers.set_DE(pop());
+  incrementPC();
+}
 
-    // Increment the contents of memory specified by register pair HL by 1.
-    case Instruction::Type::INC_mem_HL: {
-      auto data = memory->readByte(registers.get_HL());
-      registers.F.halfCarry = (data & 0xF) == 0xF;
-      ++data;
-      registers.F.zero = data == 0;
-      registers.F.subtraction = false;
-      memory->writeByte(registers.get_HL(), data);
-
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JP_NC_a16>() {
+  if (!registers.F.carry) {
+    PC = memory->readWord(PC + 1);
+    ++cycles;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Decrement the conents of memory specified by register pair HL by 1.
-    case Instruction::Type::DEC_mem_HL: {
-      uint8_t data = memory->readByte(registers.get_HL());
-      --data;
-      registers.F.zero = data == 0;
-      registers.F.subtraction = true;
-      registers.F.halfCarry = (data & 0xF) == 0xF;
-      memory->writeByte(registers.get_HL(), data);
-
-      incrementPC();
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CALL_NC_a16>() {
+  if (!registers.F.carry) {
+    uint16_t a16 = memory->readWord(PC + 1);
+    push(PC + 3);
+    setPC(a16);
+    cycles += 3;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Decrement the contents of register SP by 1
-    case Instruction::Type::DEC_SP: {
-      --SP;
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::PUSH_DE>() {
+  push(registers.get_DE());
+  incrementPC();
+}
 
-    // Decrement the contents of register DE by 1
-    case Instruction::Type::DEC_DE: {
-      registers.set_DE(registers.get_DE() - 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SUB_d8>() {
+  sub(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    // Decrement the contents of register BC by 1
-    case Instruction::Type::DEC_BC: {
-      registers.set_BC(registers.get_BC() - 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_2>() {
+  rst(0x10);
+}
 
-    // Decrement the contents of register HL by 1
-    case Instruction::Type::DEC_HL: {
-      registers.set_HL(registers.get_HL() - 1);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RET_C>() {
+  if (registers.F.carry) {
+    PC = pop();
+    cycles += 3;
+  } else {
+    incrementPC();
+  }
+}
 
-    // Increment the contents of register A by 1.
-    case Instruction::Type::INC_A: {
-      inc(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RETI>() {
+  PC = pop();
+  IME = true;
+}
 
-    // Load the 8-bit immediate operand d8 into register H.
-    case Instruction::Type::LD_H_d8: {
-      registers.H = memory->readByte(PC + 1);
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JP_C_a16>() {
+  if (registers.F.carry) {
+    PC = memory->readWord(PC + 1);
+    ++cycles;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Store the contents of 8-bit immediate operand d8 in the memory location
-    // specified by register pair HL.
-    case Instruction::Type::LD_HL_d8: {
-      memory->writeByte(registers.get_HL(), memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 3;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::CALL_C_a16>() {
+  if (registers.F.carry) {
+    uint16_t a16 = memory->readWord(PC + 1);
+    push(PC + 3);
+    setPC(a16);
+    cycles += 3;
+  } else {
+    setPC(PC + 3);
+  }
+}
 
-    // Rotate the contents of register A to the right
-    case Instruction::Type::RRCA: {
-      rrc(registers.A);
-      registers.F.zero = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::SBC_A_d8>() {
+  sbc(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    // Rotate the contents of register A to the left
-    case Instruction::Type::RLCA: {
-      rlc(registers.A);
-      registers.F.zero = false;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_3>() {
+  rst(0x18);
+}
 
-    case Instruction::Type::STOP: {
-      halted = true;
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Store the contents of register A in the internal RAM, port register, or
+// mode register at the address in the range 0xFF00-0xFFFF specified by
+// the 8-bit immediate operand a8.
+template <>
+void CPU::execute<Instruction::Type::LD_a8_A>() {
+  memory->writeByte(0xFF00 + memory->readByte(PC + 1), registers.A);
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::ADC_A_A: {
-      adc(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Pop the contents from the memory stack into register pair into register
+// pair HL
+template <>
+void CPU::execute<Instruction::Type::POP_HL>() {
+  registers.set_HL(pop());
+  incrementPC();
+}
 
-    case Instruction::Type::ADC_A_B: {
-      adc(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Store the contents of register A in the internal RAM, port register, or
+// mode register at the address in the range 0xFF00-0xFFFF specified by
+// register C.
+template <>
+void CPU::execute<Instruction::Type::LD_mem_C_A>() {
+  memory->writeByte(0xFF00 + registers.C, registers.A);
+  incrementPC();
+}
 
-    case Instruction::Type::ADC_A_C: {
-      adc(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Push the contents of register pair HL onto the memory stack.
+template <>
+void CPU::execute<Instruction::Type::PUSH_HL>() {
+  push(registers.get_HL());
+  incrementPC();
+}
 
-    case Instruction::Type::ADC_A_D: {
-      adc(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Take the logical AND for each bit of the contents of 8-bit immediate
+// operand d8 and the contents of register A, and store the results in
+// register A.
+template <>
+void CPU::execute<Instruction::Type::AND_d8>() {
+  and_(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::ADC_A_E: {
-      adc(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_4>() {
+  rst(0x20);
+}
 
-    case Instruction::Type::ADC_A_H: {
-      adc(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::ADD_SP_s8>() {
+  incrementPC();
+  uint8_t u_s8 = memory->readByte(PC);
+  int8_t off = (int8_t)u_s8;
+  uint32_t res = SP + off;
+  registers.F.zero = false;
+  registers.F.subtraction = false;
+  registers.F.halfCarry = (SP & 0xf) + (u_s8 & 0xf) > 0xf;
+  registers.F.carry = (SP & 0xff) + (u_s8 & 0xff) > 0xff;
+  SP = res;
+  incrementPC();
+}
 
-    case Instruction::Type::ADC_A_L: {
-      adc(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::JP_HL>() {
+  PC = registers.get_HL();
+}
 
-    case Instruction::Type::ADC_A_HL: {
-      adc(memory->readByte(registers.get_HL()));
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+// Store the contents of register A in the internal RAM or register
+// specified by the 16-bit immediate operand a16.
+template <>
+void CPU::execute<Instruction::Type::LD_a16_A>() {
+  memory->writeByte(memory->readWord(PC + 1), registers.A);
+  setPC(PC + 3);
+}
 
-    case Instruction::Type::ADD_A_A: {
-      add(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::XOR_d8>() {
+  xor_(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::ADD_A_B: {
-      add(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_5>() {
+  rst(0x28);
+}
 
-    case Instruction::Type::ADD_A_C: {
-      add(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load into register A the contents of the internal RAM, port register,
+// or mode register at the address in the range 0xFF00-0xFFFF specified by
+// the 8-bit immediate operand a8.
+template <>
+void CPU::execute<Instruction::Type::LD_A_a8>() {
+  registers.A =
+      memory->readByte(0xFF00 + (uint16_t)memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::ADD_A_D: {
-      add(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Pop the contents from the memory stack into register pair into register
+// pair AF
+template <>
+void CPU::execute<Instruction::Type::POP_AF>() {
+  registers.set_AF(pop());
+  incrementPC();
+}
 
-    case Instruction::Type::ADD_A_E: {
-      add(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_A_mem_C>() {
+  registers.A = memory->readByte(0xFF00 + registers.C);
+  incrementPC();
+}
 
-    case Instruction::Type::ADD_A_H: {
-      add(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Reset the interrupt master enable (IME) flag and prohibit maskable
+// interrupts.
+template <>
+void CPU::execute<Instruction::Type::DI>() {
+  IME = false;
+  incrementPC();
+}
 
-    case Instruction::Type::ADD_A_L: {
-      add(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Push the contents of register pair AF onto the memory stack
+template <>
+void CPU::execute<Instruction::Type::PUSH_AF>() {
+  push(registers.get_AF());
+  incrementPC();
+}
 
-    // Store the contents of register A in the memory location specified by
-    // register pair DE.
-    case Instruction::Type::LD_DE_A: {
-      memory->writeByte(registers.get_DE(), registers.A);
-      incrementPC();
-      cycles += 2;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::OR_d8>() {
+  or_(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::SUB_A: {
-      sub(registers.A);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_6>() {
+  rst(0x30);
+}
 
-    case Instruction::Type::SUB_B: {
-      sub(registers.B);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Add the 8-bit signed operand s8 (values -128 to +127) to the stack
+// pointer SP, and store the result in register pair HL.
+template <>
+void CPU::execute<Instruction::Type::LD_HL_SP_inc_s8>() {
+  incrementPC();
+  uint8_t u_s8 = memory->readByte(PC);
+  uint32_t res = (uint32_t)SP + (int8_t)u_s8;
+  registers.F.zero = false;
+  registers.F.subtraction = false;
+  registers.F.halfCarry = (SP & 0xf) + (u_s8 & 0xf) > 0xf;
+  registers.F.carry = (SP & 0xff) + (u_s8 & 0xff) > 0xff;
+  registers.set_HL((uint16_t)res);
+  incrementPC();
+}
 
-    case Instruction::Type::SUB_C: {
-      sub(registers.C);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::LD_SP_HL>() {
+  SP = registers.get_HL();
+  incrementPC();
+}
 
-    case Instruction::Type::SUB_D: {
-      sub(registers.D);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Load into register A the contents of the internal RAM or register
+// specified by the 16-bit immediate operand a16.
+template <>
+void CPU::execute<Instruction::Type::LD_A_a16>() {
+  registers.A = memory->readByte(memory->readWord(PC + 1));
+  setPC(PC + 3);
+}
 
-    case Instruction::Type::SUB_E: {
-      sub(registers.E);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::EI>() {
+  IME = true;
+  incrementPC();
+}
 
-    case Instruction::Type::SUB_H: {
-      sub(registers.H);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+// Compare the contents of register A and the contents of the 8-bit
+// immediate operand d8 by calculating A - d8, and set the Z flag if they
+// are equal.
+template <>
+void CPU::execute<Instruction::Type::CP_d8>() {
+  cp(memory->readByte(PC + 1));
+  setPC(PC + 2);
+}
 
-    case Instruction::Type::SUB_L: {
-      sub(registers.L);
-      incrementPC();
-      ++cycles;
-      break;
-    }
+template <>
+void CPU::execute<Instruction::Type::RST_7>() {
+  rst(0x38);
+}
 
-    case Instruction::Type::SUB_HL: {
-      sub(memory->readByte(registers.get_HL()));
-      cycles += 2;
-      incrementPC();
-      break;
-    }
+// ======================
+// ==== OPCODE TABLE ====
+// ======================
 
-    case Instruction::Type::SBC_A_d8: {
-      sbc(memory->readByte(PC + 1));
-      setPC(PC + 2);
-      cycles += 2;
-      break;
-    }
+template <size_t I>
+constexpr Opcode makeOpcode() {
+  if constexpr (I < 0x100) {
+    return {&CPU::execute<(Instruction::Type)I>, INSTRUCTION_LENGTHS[I],
+            CYCLES_PER_INSTRUCTION[I] / 4};
+  } else {
+    return {&CPU::execute<(Instruction::Type)(0xCB00 | (I & 0xFF))>, 2,
+            CYCLES_PER_INSTRUCTION_CB[I & 0xFF] / 4};
+  }
+}
 
-    case Instruction::Type::ADD_SP_s8: {
-      incrementPC();
-      uint8_t u_s8 = memory->readByte(PC);
-      int8_t off = (int8_t)u_s8;
-      uint32_t res = SP + off;
-      registers.F.zero = false;
-      registers.F.subtraction = false;
-      registers.F.halfCarry = (SP & 0xf) + (u_s8 & 0xf) > 0xf;
-      registers.F.carry = (SP & 0xff) + (u_s8 & 0xff) > 0xff;
-      SP = res;
-      incrementPC();
-      cycles += 4;
-      break;
-    }
+template <size_t... I>
+constexpr std::array<Opcode, 512> makeOpcodeTable(std::index_sequence<I...>) {
+  return {{makeOpcode<I>()...}};
+}
 
-    case Instruction::Type::JP_HL: {
-      PC = registers.get_HL();
-      ++cycles;
-      break;
-    }
+constexpr std::array<Opcode, 512> OPCODE_TABLE =
+    makeOpcodeTable(std::make_index_sequence<512>());
 
-    case Instruction::Type::SBC_A_A: {
-      sbc(registers.A);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+void CPU::tick() {
+  if (executionMode == ExecutionMode::CACHED_BLOCKS) {
+    runCachedBlock(1);
+    return;
+  }
 
-    case Instruction::Type::SBC_A_B: {
-      sbc(registers.B);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+  uint16_t opcode = memory->readByte(PC);
+  if (opcode == 0xCB) opcode = 0x100 | memory->readByte(PC + 1);
 
-    case Instruction::Type::SBC_A_C: {
-      sbc(registers.C);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+  const Opcode &op = OPCODE_TABLE[opcode];
 
-    case Instruction::Type::SBC_A_D: {
-      sbc(registers.D);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+#ifdef DEBUG_LOG
+  Instruction instruction(
+      (Instruction::Type)(opcode > 0xFF ? 0xCB00 | (opcode & 0xFF) : opcode));
+  printf(
+      "IME=%d LY: %02X A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X "
+      "SP:%04X "
+      "PC:%04X "
+      "PCMEM:%02X,%02X,%02X,%02X OP:%02X %s\n",
+      IME ? 1 : 0, memory->readByte(0xFF44), registers.A,
+      registers.F.getValue(), registers.B, registers.C, registers.D,
+      registers.E, registers.H, registers.L, SP, PC, memory->readByte(PC + 1),
+      memory->readByte(PC + 2), memory->readByte(PC + 3),
+      memory->readByte(PC + 4), memory->readByte(PC),
+      instruction.TypeRepr().c_str());
+#endif
 
-    case Instruction::Type::SBC_A_E: {
-      sbc(registers.E);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+  cycles += op.cycles;
+  (this->*op.handler)();
+}
 
-    case Instruction::Type::SBC_A_H: {
-      sbc(registers.H);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+void CPU::save(Snapshot &snapshot) {
+  snapshot.A = registers.A;
+  snapshot.B = registers.B;
+  snapshot.C = registers.C;
+  snapshot.D = registers.D;
+  snapshot.E = registers.E;
+  snapshot.F = registers.F.getValue();
+  snapshot.H = registers.H;
+  snapshot.L = registers.L;
+  snapshot.PC = PC;
+  snapshot.SP = SP;
+  snapshot.IME = IME;
+  snapshot.halted = halted;
+  snapshot.stopped = stopped;
+  snapshot.cycles = cycles;
+}
 
-    case Instruction::Type::SBC_A_L: {
-      sbc(registers.L);
-      ++cycles;
-      incrementPC();
-      break;
-    }
+void CPU::load(const Snapshot &snapshot) {
+  registers.A = snapshot.A;
+  registers.B = snapshot.B;
+  registers.C = snapshot.C;
+  registers.D = snapshot.D;
+  registers.E = snapshot.E;
+  registers.F.setValue(snapshot.F);
+  registers.H = snapshot.H;
+  registers.L = snapshot.L;
+  PC = snapshot.PC;
+  SP = snapshot.SP;
+  IME = snapshot.IME;
+  halted = snapshot.halted;
+  stopped = snapshot.stopped;
+  cycles = snapshot.cycles;
+  block = NULL;
+}
 
-    case Instruction::Type::SBC_A_HL: {
-      sbc(memory->readByte(registers.get_HL()));
-      cycles += 2;
-      incrementPC();
-      break;
-    }
+void CPU::setExecutionMode(ExecutionMode mode) {
+  executionMode = mode;
+  block = NULL;
+  blockCache.clear();
+  memory->blockCache =
+      mode == ExecutionMode::CACHED_BLOCKS ? &blockCache : NULL;
+}
 
-    case Instruction::Type::RET_Z: {
-      if (registers.F.zero) {
-        PC = pop();
-        cycles += 5;
-      } else {
-        incrementPC();
-        cycles += 2;
-      }
-      break;
-    }
+int CPU::runCachedBlock(int budget) {
+  int startCycles = cycles;
 
-    case Instruction::Type::RET_NZ: {
-      if (!registers.F.zero) {
-        PC = pop();
-        cycles += 5;
-      } else {
-        incrementPC();
-        cycles += 2;
-      }
-      break;
-    }
+  while (cycles - startCycles < budget && !halted) {
+    // Re-enter the cache whenever control leaves the straight-line path:
+    // after a branch, an interrupt, or a write that dropped this block.
+    if (block == NULL || PC != blockPC ||
+        blockGeneration != blockCache.generation()) {
+      if (cycles != startCycles) break;
 
-    case Instruction::Type::RETI: {
-      PC = pop();
-      IME = true;
-      cycles += 4;
-      break;
+      block = blockCache.get(PC);
+      blockIndex = 0;
+      blockPC = PC;
+      blockGeneration = blockCache.generation();
     }
 
-    case Instruction::Type::LD_A_mem_C: {
-      registers.A = memory->readByte(0xFF00 + registers.C);
-      cycles += 2;
-      incrementPC();
-      break;
-    }
+    const Opcode *op = block->instructions[blockIndex];
+    blockPC += op->length;
+    if (++blockIndex == block->instructions.size()) block = NULL;
 
-    case Instruction::Type::OR_d8: {
-      or_(memory->readByte(PC + 1));
-      cycles += 2;
-      setPC(PC + 2);
-      break;
-    }
+    cycles += op->cycles;
+    (this->*op->handler)();
 
-    // Add the 8-bit signed operand s8 (values -128 to +127) to the stack
-    // pointer SP, and store the result in register pair HL.
-    case Instruction::Type::LD_HL_SP_inc_s8: {
-      incrementPC();
-      uint8_t u_s8 = memory->readByte(PC);
-      uint32_t res = (uint32_t)SP + (int8_t)u_s8;
-      registers.F.zero = false;
-      registers.F.subtraction = false;
-      registers.F.halfCarry = (SP & 0xf) + (u_s8 & 0xf) > 0xf;
-      registers.F.carry = (SP & 0xff) + (u_s8 & 0xff) > 0xff;
-      registers.set_HL((uint16_t)res);
-      incrementPC();
-      cycles += 3;
+    // An interrupt made due by this instruction is taken right after it, as
+    // in the interpreter. Events only raise them between calls, and EI, DI
+    // and RETI end their blocks.
+    if (memory->interruptCheck) {
+      memory->interruptCheck = false;
       break;
     }
-
-    case Instruction::Type::LD_SP_HL: {
-      SP = registers.get_HL();
-      cycles += 2;
-      incrementPC();
+    if (IME && (memory->memory[0xFFFF] & memory->memory[0xFF0F] & 0x1F) != 0)
       break;
-    }
-
-      // =============================
-      // === Prefixed instructions ===
-      // =============================
-
-    default: {
-      throw std::runtime_error(
-          std::string(
-              "Encountered invalid instruction type. Instruction Type: ") +
-          instruction->TypeRepr());
-    }
   }
 
-  return PC;
-}
-
-void CPU::tick() {
-  uint16_t opcode = memory->readByte(PC);
-
-  bool isPrefixed = opcode == 0xCB;
-  if (isPrefixed) opcode = memory->readByte(PC + 1);
-
-  Instruction instruction = Instruction(opcode, isPrefixed);
-  PC = executeInstruction(&instruction);
+  return cycles - startCycles;
 }
 
 // ======================
@@ -2389,534 +2218,6 @@ void CPU::rst(uint8_t addr) {
 // -- Instruction class methods --
 // -------------------------------
 
-// Generate an instruction object given an opcode.
-Instruction::Instruction(uint16_t opcode, bool isPrefixed) {
-  if (!isPrefixed) {
-    switch (opcode) {
-      case (int)Type::NOP:
-      case (int)Type::LD_BC_d16:
-      case (int)Type::LD_BC_A:
-      case (int)Type::INC_BC:
-      case (int)Type::INC_B:
-      case (int)Type::DEC_B:
-      case (int)Type::LD_B_d8:
-      case (int)Type::RLCA:
-      case (int)Type::LD_a16_SP:
-      case (int)Type::ADD_HL_BC:
-      case (int)Type::LD_A_BC:
-      case (int)Type::DEC_BC:
-      case (int)Type::INC_C:
-      case (int)Type::DEC_C:
-      case (int)Type::LD_C_d8:
-      case (int)Type::RRCA:
-      case (int)Type::STOP:
-      case (int)Type::LD_DE_d16:
-      case (int)Type::LD_DE_A:
-      case (int)Type::INC_DE:
-      case (int)Type::INC_D:
-      case (int)Type::DEC_D:
-      case (int)Type::LD_D_d8:
-      case (int)Type::RLA:
-      case (int)Type::JR_s8:
-      case (int)Type::ADD_HL_DE:
-      case (int)Type::LD_A_DE:
-      case (int)Type::DEC_DE:
-      case (int)Type::INC_E:
-      case (int)Type::DEC_E:
-      case (int)Type::LD_E_d8:
-      case (int)Type::RRA:
-      case (int)Type::JR_NZ_s8:
-      case (int)Type::LD_HL_d16:
-      case (int)Type::LD_HL_inc__A:
-      case (int)Type::INC_HL:
-      case (int)Type::INC_H:
-      case (int)Type::DEC_H:
-      case (int)Type::LD_H_d8:
-      case (int)Type::DAA:
-      case (int)Type::JR_Z_s8:
-      case (int)Type::ADD_HL_HL:
-      case (int)Type::LD_A_HL_inc_:
-      case (int)Type::DEC_HL:
-      case (int)Type::INC_L:
-      case (int)Type::DEC_L:
-      case (int)Type::LD_L_d8:
-      case (int)Type::CPL:
-      case (int)Type::JR_NC_s8:
-      case (int)Type::LD_SP_d16:
-      case (int)Type::LD_HL_dec_A:
-      case (int)Type::INC_SP:
-      case (int)Type::INC_mem_HL:
-      case (int)Type::DEC_mem_HL:
-      case (int)Type::LD_HL_d8:
-      case (int)Type::SCF:
-      case (int)Type::JR_C_s8:
-      case (int)Type::ADD_HL_SP:
-      case (int)Type::LD_A_HL_dec_:
-      case (int)Type::DEC_SP:
-      case (int)Type::INC_A:
-      case (int)Type::DEC_A:
-      case (int)Type::LD_A_d8:
-      case (int)Type::CCF:
-      case (int)Type::LD_B_B:
-      case (int)Type::LD_B_C:
-      case (int)Type::LD_B_D:
-      case (int)Type::LD_B_E:
-      case (int)Type::LD_B_H:
-      case (int)Type::LD_B_L:
-      case (int)Type::LD_B_HL:
-      case (int)Type::LD_B_A:
-      case (int)Type::LD_C_B:
-      case (int)Type::LD_C_C:
-      case (int)Type::LD_C_D:
-      case (int)Type::LD_C_E:
-      case (int)Type::LD_C_H:
-      case (int)Type::LD_C_L:
-      case (int)Type::LD_C_HL:
-      case (int)Type::LD_C_A:
-      case (int)Type::LD_D_B:
-      case (int)Type::LD_D_C:
-      case (int)Type::LD_D_D:
-      case (int)Type::LD_D_E:
-      case (int)Type::LD_D_H:
-      case (int)Type::LD_D_L:
-      case (int)Type::LD_D_HL:
-      case (int)Type::LD_D_A:
-      case (int)Type::LD_E_B:
-      case (int)Type::LD_E_C:
-      case (int)Type::LD_E_D:
-      case (int)Type::LD_E_E:
-      case (int)Type::LD_E_H:
-      case (int)Type::LD_E_L:
-      case (int)Type::LD_E_HL:
-      case (int)Type::LD_E_A:
-      case (int)Type::LD_H_B:
-      case (int)Type::LD_H_C:
-      case (int)Type::LD_H_D:
-      case (int)Type::LD_H_E:
-      case (int)Type::LD_H_H:
-      case (int)Type::LD_H_L:
-      case (int)Type::LD_H_HL:
-      case (int)Type::LD_H_A:
-      case (int)Type::LD_L_B:
-      case (int)Type::LD_L_C:
-      case (int)Type::LD_L_D:
-      case (int)Type::LD_L_E:
-      case (int)Type::LD_L_H:
-      case (int)Type::LD_L_L:
-      case (int)Type::LD_L_HL:
-      case (int)Type::LD_L_A:
-      case (int)Type::LD_HL_B:
-      case (int)Type::LD_HL_C:
-      case (int)Type::LD_HL_D:
-      case (int)Type::LD_HL_E:
-      case (int)Type::LD_HL_H:
-      case (int)Type::LD_HL_L:
-      case (int)Type::HALT:
-      case (int)Type::LD_HL_A:
-      case (int)Type::LD_A_B:
-      case (int)Type::LD_A_C:
-      case (int)Type::LD_A_D:
-      case (int)Type::LD_A_E:
-      case (int)Type::LD_A_H:
-      case (int)Type::LD_A_L:
-      case (int)Type::LD_A_HL:
-      case (int)Type::LD_A_A:
-      case (int)Type::ADD_A_B:
-      case (int)Type::ADD_A_C:
-      case (int)Type::ADD_A_D:
-      case (int)Type::ADD_A_E:
-      case (int)Type::ADD_A_H:
-      case (int)Type::ADD_A_L:
-      case (int)Type::ADD_A_HL:
-      case (int)Type::ADD_A_A:
-      case (int)Type::ADC_A_B:
-      case (int)Type::ADC_A_C:
-      case (int)Type::ADC_A_D:
-      case (int)Type::ADC_A_E:
-      case (int)Type::ADC_A_H:
-      case (int)Type::ADC_A_L:
-      case (int)Type::ADC_A_HL:
-      case (int)Type::ADC_A_A:
-      case (int)Type::SUB_B:
-      case (int)Type::SUB_C:
-      case (int)Type::SUB_D:
-      case (int)Type::SUB_E:
-      case (int)Type::SUB_H:
-      case (int)Type::SUB_L:
-      case (int)Type::SUB_HL:
-      case (int)Type::SUB_A:
-      case (int)Type::SBC_A_B:
-      case (int)Type::SBC_A_C:
-      case (int)Type::SBC_A_D:
-      case (int)Type::SBC_A_E:
-      case (int)Type::SBC_A_H:
-      case (int)Type::SBC_A_L:
-      case (int)Type::SBC_A_HL:
-      case (int)Type::SBC_A_A:
-      case (int)Type::AND_B:
-      case (int)Type::AND_C:
-      case (int)Type::AND_D:
-      case (int)Type::AND_E:
-      case (int)Type::AND_H:
-      case (int)Type::AND_L:
-      case (int)Type::AND_HL:
-      case (int)Type::AND_A:
-      case (int)Type::XOR_B:
-      case (int)Type::XOR_C:
-      case (int)Type::XOR_D:
-      case (int)Type::XOR_E:
-      case (int)Type::XOR_H:
-      case (int)Type::XOR_L:
-      case (int)Type::XOR_HL:
-      case (int)Type::XOR_A:
-      case (int)Type::OR_B:
-      case (int)Type::OR_C:
-      case (int)Type::OR_D:
-      case (int)Type::OR_E:
-      case (int)Type::OR_H:
-      case (int)Type::OR_L:
-      case (int)Type::OR_HL:
-      case (int)Type::OR_A:
-      case (int)Type::CP_B:
-      case (int)Type::CP_C:
-      case (int)Type::CP_D:
-      case (int)Type::CP_E:
-      case (int)Type::CP_H:
-      case (int)Type::CP_L:
-      case (int)Type::CP_HL:
-      case (int)Type::CP_A:
-      case (int)Type::RET_NZ:
-      case (int)Type::POP_BC:
-      case (int)Type::JP_NZ_a16:
-      case (int)Type::JP_a16:
-      case (int)Type::CALL_NZ_a16:
-      case (int)Type::PUSH_BC:
-      case (int)Type::ADD_A_d8:
-      case (int)Type::RST_0:
-      case (int)Type::RET_Z:
-      case (int)Type::RET:
-      case (int)Type::JP_Z_a16:
-      case (int)Type::CALL_Z_a16:
-      case (int)Type::CALL_a16:
-      case (int)Type::ADC_A_d8:
-      case (int)Type::RST_1:
-      case (int)Type::RET_NC:
-      case (int)Type::POP_DE:
-      case (int)Type::JP_NC_a16:
-      case (int)Type::CALL_NC_a16:
-      case (int)Type::PUSH_DE:
-      case (int)Type::SUB_d8:
-      case (int)Type::RST_2:
-      case (int)Type::RET_C:
-      case (int)Type::RETI:
-      case (int)Type::JP_C_a16:
-      case (int)Type::CALL_C_a16:
-      case (int)Type::SBC_A_d8:
-      case (int)Type::RST_3:
-      case (int)Type::LD_a8_A:
-      case (int)Type::POP_HL:
-      case (int)Type::LD_mem_C_A:
-      case (int)Type::PUSH_HL:
-      case (int)Type::AND_d8:
-      case (int)Type::RST_4:
-      case (int)Type::ADD_SP_s8:
-      case (int)Type::JP_HL:
-      case (int)Type::LD_a16_A:
-      case (int)Type::XOR_d8:
-      case (int)Type::RST_5:
-      case (int)Type::LD_A_a8:
-      case (int)Type::POP_AF:
-      case (int)Type::LD_A_mem_C:
-      case (int)Type::DI:
-      case (int)Type::PUSH_AF:
-      case (int)Type::OR_d8:
-      case (int)Type::RST_6:
-      case (int)Type::LD_HL_SP_inc_s8:
-      case (int)Type::LD_SP_HL:
-      case (int)Type::LD_A_a16:
-      case (int)Type::EI:
-      case (int)Type::CP_d8:
-      case (int)Type::RST_7:
-        type_ = (Type)opcode;
-        break;
-
-      default: {
-        throw std::runtime_error(
-            std::string("Invalid non-prefixed instruction opcode: ") +
-            TypeRepr());
-      }
-    }
-  } else {
-    switch (0xCB00 | opcode) {
-      // Prefixed instructions
-      case (int)Type::RLC_B:
-      case (int)Type::RLC_C:
-      case (int)Type::RLC_D:
-      case (int)Type::RLC_E:
-      case (int)Type::RLC_H:
-      case (int)Type::RLC_L:
-      case (int)Type::RLC_HL:
-      case (int)Type::RLC_A:
-      case (int)Type::RRC_B:
-      case (int)Type::RRC_C:
-      case (int)Type::RRC_D:
-      case (int)Type::RRC_E:
-      case (int)Type::RRC_H:
-      case (int)Type::RRC_L:
-      case (int)Type::RRC_HL:
-      case (int)Type::RRC_A:
-      case (int)Type::RL_B:
-      case (int)Type::RL_C:
-      case (int)Type::RL_D:
-      case (int)Type::RL_E:
-      case (int)Type::RL_H:
-      case (int)Type::RL_L:
-      case (int)Type::RL_HL:
-      case (int)Type::RL_A:
-      case (int)Type::RR_B:
-      case (int)Type::RR_C:
-      case (int)Type::RR_D:
-      case (int)Type::RR_E:
-      case (int)Type::RR_H:
-      case (int)Type::RR_L:
-      case (int)Type::RR_HL:
-      case (int)Type::RR_A:
-      case (int)Type::SLA_B:
-      case (int)Type::SLA_C:
-      case (int)Type::SLA_D:
-      case (int)Type::SLA_E:
-      case (int)Type::SLA_H:
-      case (int)Type::SLA_L:
-      case (int)Type::SLA_HL:
-      case (int)Type::SLA_A:
-      case (int)Type::SRA_B:
-      case (int)Type::SRA_C:
-      case (int)Type::SRA_D:
-      case (int)Type::SRA_E:
-      case (int)Type::SRA_H:
-      case (int)Type::SRA_L:
-      case (int)Type::SRA_HL:
-      case (int)Type::SRA_A:
-      case (int)Type::SWAP_B:
-      case (int)Type::SWAP_C:
-      case (int)Type::SWAP_D:
-      case (int)Type::SWAP_E:
-      case (int)Type::SWAP_H:
-      case (int)Type::SWAP_L:
-      case (int)Type::SWAP_HL:
-      case (int)Type::SWAP_A:
-      case (int)Type::SRL_B:
-      case (int)Type::SRL_C:
-      case (int)Type::SRL_D:
-      case (int)Type::SRL_E:
-      case (int)Type::SRL_H:
-      case (int)Type::SRL_L:
-      case (int)Type::SRL_HL:
-      case (int)Type::SRL_A:
-      case (int)Type::BIT_0_B:
-      case (int)Type::BIT_0_C:
-      case (int)Type::BIT_0_D:
-      case (int)Type::BIT_0_E:
-      case (int)Type::BIT_0_H:
-      case (int)Type::BIT_0_L:
-      case (int)Type::BIT_0_HL:
-      case (int)Type::BIT_0_A:
-      case (int)Type::BIT_1_B:
-      case (int)Type::BIT_1_C:
-      case (int)Type::BIT_1_D:
-      case (int)Type::BIT_1_E:
-      case (int)Type::BIT_1_H:
-      case (int)Type::BIT_1_L:
-      case (int)Type::BIT_1_HL:
-      case (int)Type::BIT_1_A:
-      case (int)Type::BIT_2_B:
-      case (int)Type::BIT_2_C:
-      case (int)Type::BIT_2_D:
-      case (int)Type::BIT_2_E:
-      case (int)Type::BIT_2_H:
-      case (int)Type::BIT_2_L:
-      case (int)Type::BIT_2_HL:
-      case (int)Type::BIT_2_A:
-      case (int)Type::BIT_3_B:
-      case (int)Type::BIT_3_C:
-      case (int)Type::BIT_3_D:
-      case (int)Type::BIT_3_E:
-      case (int)Type::BIT_3_H:
-      case (int)Type::BIT_3_L:
-      case (int)Type::BIT_3_HL:
-      case (int)Type::BIT_3_A:
-      case (int)Type::BIT_4_B:
-      case (int)Type::BIT_4_C:
-      case (int)Type::BIT_4_D:
-      case (int)Type::BIT_4_E:
-      case (int)Type::BIT_4_H:
-      case (int)Type::BIT_4_L:
-      case (int)Type::BIT_4_HL:
-      case (int)Type::BIT_4_A:
-      case (int)Type::BIT_5_B:
-      case (int)Type::BIT_5_C:
-      case (int)Type::BIT_5_D:
-      case (int)Type::BIT_5_E:
-      case (int)Type::BIT_5_H:
-      case (int)Type::BIT_5_L:
-      case (int)Type::BIT_5_HL:
-      case (int)Type::BIT_5_A:
-      case (int)Type::BIT_6_B:
-      case (int)Type::BIT_6_C:
-      case (int)Type::BIT_6_D:
-      case (int)Type::BIT_6_E:
-      case (int)Type::BIT_6_H:
-      case (int)Type::BIT_6_L:
-      case (int)Type::BIT_6_HL:
-      case (int)Type::BIT_6_A:
-      case (int)Type::BIT_7_B:
-      case (int)Type::BIT_7_C:
-      case (int)Type::BIT_7_D:
-      case (int)Type::BIT_7_E:
-      case (int)Type::BIT_7_H:
-      case (int)Type::BIT_7_L:
-      case (int)Type::BIT_7_HL:
-      case (int)Type::BIT_7_A:
-      case (int)Type::RES_0_B:
-      case (int)Type::RES_0_C:
-      case (int)Type::RES_0_D:
-      case (int)Type::RES_0_E:
-      case (int)Type::RES_0_H:
-      case (int)Type::RES_0_L:
-      case (int)Type::RES_0_HL:
-      case (int)Type::RES_0_A:
-      case (int)Type::RES_1_B:
-      case (int)Type::RES_1_C:
-      case (int)Type::RES_1_D:
-      case (int)Type::RES_1_E:
-      case (int)Type::RES_1_H:
-      case (int)Type::RES_1_L:
-      case (int)Type::RES_1_HL:
-      case (int)Type::RES_1_A:
-      case (int)Type::RES_2_B:
-      case (int)Type::RES_2_C:
-      case (int)Type::RES_2_D:
-      case (int)Type::RES_2_E:
-      case (int)Type::RES_2_H:
-      case (int)Type::RES_2_L:
-      case (int)Type::RES_2_HL:
-      case (int)Type::RES_2_A:
-      case (int)Type::RES_3_B:
-      case (int)Type::RES_3_C:
-      case (int)Type::RES_3_D:
-      case (int)Type::RES_3_E:
-      case (int)Type::RES_3_H:
-      case (int)Type::RES_3_L:
-      case (int)Type::RES_3_HL:
-      case (int)Type::RES_3_A:
-      case (int)Type::RES_4_B:
-      case (int)Type::RES_4_C:
-      case (int)Type::RES_4_D:
-      case (int)Type::RES_4_E:
-      case (int)Type::RES_4_H:
-      case (int)Type::RES_4_L:
-      case (int)Type::RES_4_HL:
-      case (int)Type::RES_4_A:
-      case (int)Type::RES_5_B:
-      case (int)Type::RES_5_C:
-      case (int)Type::RES_5_D:
-      case (int)Type::RES_5_E:
-      case (int)Type::RES_5_H:
-      case (int)Type::RES_5_L:
-      case (int)Type::RES_5_HL:
-      case (int)Type::RES_5_A:
-      case (int)Type::RES_6_B:
-      case (int)Type::RES_6_C:
-      case (int)Type::RES_6_D:
-      case (int)Type::RES_6_E:
-      case (int)Type::RES_6_H:
-      case (int)Type::RES_6_L:
-      case (int)Type::RES_6_HL:
-      case (int)Type::RES_6_A:
-      case (int)Type::RES_7_B:
-      case (int)Type::RES_7_C:
-      case (int)Type::RES_7_D:
-      case (int)Type::RES_7_E:
-      case (int)Type::RES_7_H:
-      case (int)Type::RES_7_L:
-      case (int)Type::RES_7_HL:
-      case (int)Type::RES_7_A:
-      case (int)Type::SET_0_B:
-      case (int)Type::SET_0_C:
-      case (int)Type::SET_0_D:
-      case (int)Type::SET_0_E:
-      case (int)Type::SET_0_H:
-      case (int)Type::SET_0_L:
-      case (int)Type::SET_0_HL:
-      case (int)Type::SET_0_A:
-      case (int)Type::SET_1_B:
-      case (int)Type::SET_1_C:
-      case (int)Type::SET_1_D:
-      case (int)Type::SET_1_E:
-      case (int)Type::SET_1_H:
-      case (int)Type::SET_1_L:
-      case (int)Type::SET_1_HL:
-      case (int)Type::SET_1_A:
-      case (int)Type::SET_2_B:
-      case (int)Type::SET_2_C:
-      case (int)Type::SET_2_D:
-      case (int)Type::SET_2_E:
-      case (int)Type::SET_2_H:
-      case (int)Type::SET_2_L:
-      case (int)Type::SET_2_HL:
-      case (int)Type::SET_2_A:
-      case (int)Type::SET_3_B:
-      case (int)Type::SET_3_C:
-      case (int)Type::SET_3_D:
-      case (int)Type::SET_3_E:
-      case (int)Type::SET_3_H:
-      case (int)Type::SET_3_L:
-      case (int)Type::SET_3_HL:
-      case (int)Type::SET_3_A:
-      case (int)Type::SET_4_B:
-      case (int)Type::SET_4_C:
-      case (int)Type::SET_4_D:
-      case (int)Type::SET_4_E:
-      case (int)Type::SET_4_H:
-      case (int)Type::SET_4_L:
-      case (int)Type::SET_4_HL:
-      case (int)Type::SET_4_A:
-      case (int)Type::SET_5_B:
-      case (int)Type::SET_5_C:
-      case (int)Type::SET_5_D:
-      case (int)Type::SET_5_E:
-      case (int)Type::SET_5_H:
-      case (int)Type::SET_5_L:
-      case (int)Type::SET_5_HL:
-      case (int)Type::SET_5_A:
-      case (int)Type::SET_6_B:
-      case (int)Type::SET_6_C:
-      case (int)Type::SET_6_D:
-      case (int)Type::SET_6_E:
-      case (int)Type::SET_6_H:
-      case (int)Type::SET_6_L:
-      case (int)Type::SET_6_HL:
-      case (int)Type::SET_6_A:
-      case (int)Type::SET_7_B:
-      case (int)Type::SET_7_C:
-      case (int)Type::SET_7_D:
-      case (int)Type::SET_7_E:
-      case (int)Type::SET_7_H:
-      case (int)Type::SET_7_L:
-      case (int)Type::SET_7_HL:
-      case (int)Type::SET_7_A:
-        type_ = (Type)(0xCB00 | opcode);
-        break;
-
-      default: {
-        throw std::runtime_error(
-            std::string("Invalid prefixed instruction opcode: ") +
-            std::to_string(opcode));
-      }
-    }
-  }
-}
-
 std::string Instruction::ArithmeticTargetRepr() {
   switch (arithmeticTarget_) {
     case A:
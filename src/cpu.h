@@ -3,9 +3,11 @@
 #include <_types/_uint16_t.h>
 #include <_types/_uint8_t.h>
 
+#include <array>
 #include <vector>
 
 #include "../lib/tester.h"
+#include "blockcache.h"
 #include "events.h"
 #include "mem.h"
 #include "registers.h"
@@ -520,7 +522,6 @@ class Instruction {
 
   };
 
-  Instruction(uint16_t opcode, bool isPrefixed);
   Instruction(Type type) : type_(type){};
   Instruction(Type type, ArithmeticTarget target)
       : type_(type), arithmeticTarget_(target) {}
@@ -543,48 +544,59 @@ struct Clock {
 
 class CPU {
  public:
-  CPU(Memory *m) : memory(m){};
-
-  uint8_t HL_mem;
-
-  uint8_t *getTargetRef(ArithmeticTarget target) {
-    switch (target) {
-      case B:
-        return &registers.B;
-
-      case C:
-        return &registers.C;
-
-      case D:
-        return &registers.D;
+  CPU(Memory *m) : memory(m), blockCache(m){};
+
+  // INTERPRETER decodes every instruction through OPCODE_TABLE as it is
+  // fetched. CACHED_BLOCKS runs pre-decoded straight-line blocks from
+  // blockCache, which Memory invalidates when code is overwritten.
+  enum class ExecutionMode { INTERPRETER, CACHED_BLOCKS };
+
+  // Register operand of a CB-prefixed instruction, resolved at compile time.
+  // (HL) operands are read and written by the handler itself.
+  template <ArithmeticTarget target>
+  uint8_t &getTargetRef() {
+    static_assert(target != HL, "(HL) is a memory operand");
+    if constexpr (target == B) return registers.B;
+    if constexpr (target == C) return registers.C;
+    if constexpr (target == D) return registers.D;
+    if constexpr (target == E) return registers.E;
+    if constexpr (target == H) return registers.H;
+    if constexpr (target == L) return registers.L;
+    if constexpr (target == A) return registers.A;
+  }
 
-      case E:
-        return &registers.E;
+  void tick();
 
-      case H:
-        return &registers.H;
+  void setExecutionMode(ExecutionMode mode);
+  ExecutionMode getExecutionMode() { return executionMode; };
 
-      case L:
-        return &registers.L;
+  // Runs cached instructions until at least `budget` machine cycles have
+  // elapsed, control leaves the current block or an interrupt may be due.
+  // Returns the cycles spent.
+  int runCachedBlock(int budget);
 
-      case HL:
-        return &HL_mem;
+  // Handler for a single opcode, see OPCODE_TABLE.
+  template <Instruction::Type T>
+  void execute();
 
-      case A:
-        return &registers.A;
-    }
-  }
+  // Operation y of group x of the CB-prefixed opcode space (x = 0 rotates and
+  // shifts, 1 BIT, 2 RES, 3 SET) applied to value.
+  template <uint8_t x, uint8_t y>
+  void executePrefixed(uint8_t &value);
 
-  void updateHL_mem() { HL_mem = memory->readByte(registers.get_HL()); }
+  // Architectural state, for save states. Loading drops the position in the
+  // current cached block; the cache itself is kept.
+  struct Snapshot {
+    uint8_t A, B, C, D, E, F, H, L;
+    uint16_t PC, SP;
+    bool IME, halted, stopped;
+    int cycles;
 
-  void setRomData(std::vector<uint8_t> &rd) {
-    for (int i = 0; i <= 256; ++i) {
-      romData.push_back(rd[i]);
-    }
-  }
+    bool operator==(const Snapshot &) const = default;
+  };
+  void save(Snapshot &snapshot);
+  void load(const Snapshot &snapshot);
 
-  uint16_t executeInstruction(Instruction *instruction);
-  void tick();
   void setPC(uint16_t newPC) { PC = newPC; };
   uint16_t incrementPC() { return ++PC; };
   uint16_t getPC() { return PC; };
@@ -592,12 +604,21 @@ class CPU {
 
   //  private:
   Memory *memory;
-  std::vector<uint8_t> romData;
   // Clock clock;
 
-  uint16_t PC;
+  uint16_t PC = 0;
   uint16_t SP = 0;
-  bool IME;
+  bool IME = false;
+
+  ExecutionMode executionMode = ExecutionMode::INTERPRETER;
+  BlockCache blockCache;
+
+  // Position in the block being executed, valid while blockGeneration
+  // matches the cache.
+  Block *block = NULL;
+  size_t blockIndex;
+  uint16_t blockPC;
+  uint64_t blockGeneration;
 
   // INSTRUCTIONS
   uint8_t add(uint8_t value);
@@ -624,83 +645,23 @@ class CPU {
   void bit(uint8_t value, uint8_t b);
   uint16_t addCompoundRegisters(uint16_t a, uint16_t b);
 
-  bool inBootRom = true;
   bool halted = false;
   bool stopped = false;
 
-  int cycles;
+  int cycles = 0;
+};
+
+// Decoded form of an opcode. CPU::tick indexes OPCODE_TABLE with the opcode
+// (or 0x100 | opcode for CB-prefixed instructions) instead of decoding it.
+struct Opcode {
+  void (CPU::*handler)();
+  uint8_t length;  // Size in bytes, including the 0xCB prefix.
+  uint8_t cycles;  // Base cost in machine cycles (branch not taken).
 };
 
-extern Memory g_Memory;
-extern CPU g_CPU;
-
-/*
- * Called once during startup. The area of memory pointed to by
- * tester_instruction_mem will contain instructions the tester will inject,
- * and should be mapped read-only at addresses
- * [0,tester_instruction_mem_size).
- */
-static void mycpu_init(size_t tester_instruction_mem_size,
-                       uint8_t *tester_instruction_mem) {
-  g_CPU.memory->memory = tester_instruction_mem;
-  g_Memory.MEM_SIZE = tester_instruction_mem_size;
-}
-
-/*
- * Resets the CPU state (e.g., registers) to a given state state.
- */
-static void mycpu_set_state(struct state *state) {
-  (void)state;
-
-  g_Memory.num_mem_accesses = 0;
-
-  g_CPU.registers.A = state->reg8.A;
-  g_CPU.registers.F.setValue(state->reg8.F);
-  g_CPU.registers.B = state->reg8.B;
-  g_CPU.registers.C = state->reg8.C;
-  g_CPU.registers.D = state->reg8.D;
-  g_CPU.registers.E = state->reg8.E;
-  g_CPU.registers.H = state->reg8.H;
-  g_CPU.registers.L = state->reg8.L;
-
-  g_CPU.SP = state->SP;
-  g_CPU.PC = state->PC;
-
-  g_CPU.halted = state->halted;
-  g_CPU.IME = state->interrupts_master_enabled;
-
-  for (int i = 0; i < 16; ++i)
-    g_Memory.mem_accesses[i] = state->mem_accesses[i];
-}
-
-static void mycpu_get_state(struct state *state) {
-  state->num_mem_accesses = g_Memory.num_mem_accesses;
-
-  state->reg8.A = g_CPU.registers.A;
-  state->reg8.F = g_CPU.registers.F.getValue();
-  state->reg8.B = g_CPU.registers.B;
-  state->reg8.C = g_CPU.registers.C;
-  state->reg8.D = g_CPU.registers.D;
-  state->reg8.E = g_CPU.registers.E;
-  state->reg8.H = g_CPU.registers.H;
-  state->reg8.L = g_CPU.registers.L;
-
-  state->SP = g_CPU.SP;
-  state->PC = g_CPU.PC;
-
-  state->halted = g_CPU.halted;
-  state->interrupts_master_enabled = g_CPU.IME;
-
-  for (int i = 0; i < 16; ++i)
-    state->mem_accesses[i] = g_Memory.mem_accesses[i];
-}
-
-static int mycpu_step(void) {
-  g_CPU.tick();
-  return g_CPU.cycles;
-}
-
-static int CYCLES_PER_INSTRUCTION[] = {
+extern const std::array<Opcode, 512> OPCODE_TABLE;
+
+static constexpr int CYCLES_PER_INSTRUCTION[] = {
     /*
     0    1  2   3   4   5   6   7    8  9   a   b  c   d   e  f   */
     4,  12, 8,  8,  4,  4,  8,  4,  20, 8,  8,  8, 4,  4,  8, 4,  /* 0 */
@@ -714,14 +675,14 @@ static int CYCLES_PER_INSTRUCTION[] = {
     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4, 4,  4,  8, 4,  /* 8 */
     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4, 4,  4,  8, 4,  /* 9 */
     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4, 4,  4,  8, 4,  /* a */
-    4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4, 8,  4,  8, 4,  /* b */
+    4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4, 4,  4,  8, 4,  /* b */
     8,  12, 12, 16, 12, 16, 8,  16, 8,  16, 12, 0, 12, 24, 8, 16, /* c */
     8,  12, 12, 4,  12, 16, 8,  16, 8,  16, 12, 4, 12, 4,  8, 16, /* d */
     12, 12, 8,  4,  4,  16, 8,  16, 16, 4,  16, 4, 4,  4,  8, 16, /* e */
     12, 12, 8,  4,  4,  16, 8,  16, 12, 8,  16, 4, 0,  4,  8, 16, /* f */
 };
 
-static int CYCLES_PER_INSTRUCTION_CB[] = {
+static constexpr int CYCLES_PER_INSTRUCTION_CB[] = {
     /*
     0  1  2  3  4  5  6   7  8  9  a  b  c  d   e  f  */
     8, 8, 8, 8, 8, 8, 16, 8, 8, 8, 8, 8, 8, 8, 16, 8, /* 0 */
@@ -741,3 +702,24 @@ static int CYCLES_PER_INSTRUCTION_CB[] = {
     8, 8, 8, 8, 8, 8, 16, 8, 8, 8, 8, 8, 8, 8, 16, 8, /* e */
     8, 8, 8, 8, 8, 8, 16, 8, 8, 8, 8, 8, 8, 8, 16, 8, /* f */
 };
+
+static constexpr uint8_t INSTRUCTION_LENGTHS[] = {
+    /*
+    0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f  */
+    1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1, /* 0 */
+    1, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, /* 1 */
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, /* 2 */
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, /* 3 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 4 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 5 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 6 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 7 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 8 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 9 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* a */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* b */
+    1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1, /* c */
+    1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 1, 2, 1, /* d */
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1, /* e */
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1, /* f */
+};
@@ -1,37 +1,30 @@
 #include "display.h"
 
-#include <SDL_error.h>
-#include <SDL_pixels.h>
-#include <SDL_render.h>
 #include <_types/_uint8_t.h>
-#include <malloc/_malloc.h>
 
 #include <cstddef>
-#include <cstdio>
 #include <cstring>
-#include <stdexcept>
 
-#include "utils.h"
+void Display::vBlank() {
+  ++this->frames;
+  offset = 0;
+  frameBuffers.publish();
+  frame = frameBuffers.back();
+}
 
-void Display::write(uint8_t pixel) {
-  for (int i = 0; i < SCALE_FACTOR; ++i) {
-    memcpy(&sdlDisplay.pixelBuffer[offset], &palette[pixel],
-           sizeof(palette[pixel]));
-    offset += 4;
-  }
+void Display::save(Snapshot &snapshot) {
+  snapshot.frames = frames;
+  snapshot.offset = offset;
+  memcpy(snapshot.frame, frame, sizeof(snapshot.frame));
 }
 
-void Display::hBlank() {
-  int scanlinePixelCount = SCREEN_WIDTH * SCALE_FACTOR * 4;
-  for (int i = 0; i < scanlinePixelCount; ++i) {
-    sdlDisplay.pixelBuffer[offset] =
-        sdlDisplay.pixelBuffer[offset - scanlinePixelCount];
-    ++offset;
-  }
+void Display::load(const Snapshot &snapshot) {
+  frames = snapshot.frames;
+  offset = snapshot.offset;
+  memcpy(frame, snapshot.frame, sizeof(snapshot.frame));
 }
 
-void Display::vBlank() {
-  ++this->frames;
-  offset = 0;
-  sdlDisplay.render();
+const uint8_t *Display::frameBuffer() {
+  frameBuffers.acquire();
+  return frameBuffers.front();
 }
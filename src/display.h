@@ -1,45 +1,48 @@
 #pragma once
 
-#include <SDL.h>
-#include <SDL_pixels.h>
-#include <SDL_render.h>
-#include <SDL_video.h>
 #include <_types/_uint8_t.h>
-#include <malloc/_malloc.h>
 
 #include <cstddef>
-#include <string>
-#include <vector>
+#include <cstdint>
 
-#include "utils.h"
+#include "triplebuffer.h"
 
+// The LCD as seen by the rest of the emulator: the PPU writes each frame's
+// palette indices (0-3) into it, and whoever shows them (a frontend, or a
+// caller of frameBuffer) reads finished frames back out. Turning indices into
+// colors is left to the reader.
 class Display {
  public:
-  Display()
-      : sdlDisplay("gameboy", this->SCREEN_WIDTH, this->SCREEN_HEIGHT,
-                   this->SCALE_FACTOR, false) {}
+  Display() : frameBuffers(SCREEN_WIDTH * SCREEN_HEIGHT) {
+    frame = frameBuffers.back();
+  }
 
-  void hBlank();
   void vBlank();
-  void write(uint8_t pixel);
+  void write(uint8_t pixel) { frame[offset++] = pixel; };
 
-  uint64_t frames;
+  // The most recently finished frame, SCREEN_WIDTH x SCREEN_HEIGHT palette
+  // indices in row order. Frames are handed over through a triple buffer with
+  // a single reader, so call it from one thread only, which need not be the
+  // one emulating.
+  const uint8_t *frameBuffer();
 
-  SDL_Color palette[4] = {
-      {0xe0, 0xf0, 0xe7, 0xff},  // White
-      {0x8b, 0xa3, 0x94, 0xff},  // Light gray
-      {0x55, 0x64, 0x5a, 0xff},  // Dark gray
-      {0x34, 0x3d, 0x37, 0xff},  // Black
+  uint64_t frames = 0;
+
+  static constexpr int SCREEN_WIDTH = 160;
+  static constexpr int SCREEN_HEIGHT = 144;
+
+  // The frame being drawn, for save states.
+  struct Snapshot {
+    uint64_t frames;
+    int offset;
+    uint8_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
   };
+  void save(Snapshot &snapshot);
+  void load(const Snapshot &snapshot);
 
  private:
+  // The PPU writes straight into the back buffer.
+  TripleBuffer frameBuffers;
+  uint8_t *frame;
   int offset = 0;
-  SDL_Display sdlDisplay;
-
-  int X = 0;
-  int Y = 0;
-
-  static const int SCREEN_WIDTH = 160;
-  static const int SCREEN_HEIGHT = 144;
-  static const int SCALE_FACTOR = 2;
 };
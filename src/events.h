@@ -3,9 +3,6 @@
 #include <_types/_uint16_t.h>
 #include <_types/_uint8_t.h>
 
-#include <functional>
-#include <unordered_map>
-
 enum GameboyEventType {
   MEM_READ_BYTE,
   MEM_READ_WORD,
@@ -26,7 +23,15 @@ struct GameboyEventData {
   GameboyMemoryEventData memory;
 };
 
-typedef std::function<void(GameboyEventData data)> GameboyEventCallback;
-
-typedef std::unordered_map<GameboyEventType, std::vector<GameboyEventCallback>>
-    GameboyEventListenerMap;
+// Plain function pointer plus an opaque context, so firing a watch is a direct
+// call rather than a std::function dispatch.
+typedef void (*GameboyEventCallback)(GameboyEventData data, void *context);
+
+// A callback on accesses to the inclusive address range [start, end].
+struct GameboyWatch {
+  GameboyEventType eventType;
+  uint16_t start;
+  uint16_t end;
+  GameboyEventCallback callback;
+  void *context;
+};
@@ -0,0 +1,51 @@
+#include "frametime.h"
+
+#include <_types/_uint64_t.h>
+
+#include <cstdio>
+
+void FrameTimeHistogram::record(uint64_t nanoseconds, bool late) {
+  size_t bucket = nanoseconds / 1000000;
+  if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+
+  ++buckets[bucket];
+  ++frames;
+  if (late) ++lateFrames;
+  totalNanoseconds += nanoseconds;
+  if (nanoseconds > maxNanoseconds) maxNanoseconds = nanoseconds;
+}
+
+void FrameTimeHistogram::clear() { *this = FrameTimeHistogram(); }
+
+uint64_t FrameTimeHistogram::percentileMilliseconds(double fraction) {
+  uint64_t threshold = (uint64_t)(frames * fraction);
+  uint64_t seen = 0;
+
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen > threshold) return i + 1;
+  }
+
+  return BUCKETS;
+}
+
+void FrameTimeHistogram::print() {
+  if (frames == 0) return;
+
+  printf("Frame times over %llu frames (%llu late):\n",
+         (unsigned long long)frames, (unsigned long long)lateFrames);
+  printf("  mean %.2fms, p50 <%llums, p99 <%llums, max %.2fms\n",
+         totalNanoseconds / 1e6 / frames,
+         (unsigned long long)percentileMilliseconds(0.5),
+         (unsigned long long)percentileMilliseconds(0.99),
+         maxNanoseconds / 1e6);
+
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    if (buckets[i] == 0) continue;
+
+    int width = (int)(buckets[i] * 50 / frames);
+    printf("  %2zu%sms %8llu %.*s\n", i, i == BUCKETS - 1 ? "+" : " ",
+           (unsigned long long)buckets[i], width,
+           "##################################################");
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <_types/_uint64_t.h>
+
+#include <cstddef>
+
+// Histogram of how long each frame took to emulate, in 1ms buckets. Also
+// counts frames that finished after their presentation deadline.
+class FrameTimeHistogram {
+ public:
+  void record(uint64_t nanoseconds, bool late);
+  void clear();
+  void print();
+
+  // Frame time below which the given fraction (0-1) of frames fell, rounded
+  // up to the bucket boundary.
+  uint64_t percentileMilliseconds(double fraction);
+
+  uint64_t frames = 0;
+  uint64_t lateFrames = 0;
+  uint64_t totalNanoseconds = 0;
+  uint64_t maxNanoseconds = 0;
+
+  static const size_t BUCKETS = 34;  // The last bucket collects 33ms and up.
+
+ private:
+  uint64_t buckets[BUCKETS] = {};
+};
@@ -0,0 +1,188 @@
+#include "frontend.h"
+
+#include <SDL.h>
+#include <SDL_events.h>
+#include <SDL_keyboard.h>
+#include <SDL_pixels.h>
+#include <_types/_uint16_t.h>
+#include <_types/_uint8_t.h>
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "display.h"
+#include "ppu.h"
+#include "tilecache.h"
+
+Frontend::Frontend(GameBoy *gb) : gameboy(gb), rewindBuffer(REWIND_BUDGET) {
+  for (int i = 0; i < 4; ++i) memcpy(&colors[i], &palette[i], 4);
+
+  screen = std::make_unique<SDL_Display>("gameboy", Display::SCREEN_WIDTH,
+                                         Display::SCREEN_HEIGHT, SCALE_FACTOR,
+                                         false);
+  tilesetDisplay = std::make_unique<SDL_Display>(
+      "Tileset", TILE_WIDTH * TILESET_WIDTH, TILE_WIDTH * TILESET_HEIGHT, 1,
+      false);
+  tilemapDisplay = std::make_unique<SDL_Display>("Tilemap", 256, 256, 1, true);
+
+  frameEvent = SDL_RegisterEvents(1);
+  gameboy->setFrameCallback(onFrame, this);
+}
+
+Frontend::~Frontend() {
+  gameboy->setFrameCallback(NULL, NULL);
+  SDL_Quit();
+}
+
+// The main thread sleeps in SDL_WaitEvent, so it handles input as soon as it
+// arrives and frames as soon as the worker posts them, even while the LCD is
+// off and no frames come.
+void Frontend::run() {
+  std::exception_ptr error;
+
+  std::thread emulator([this, &error] {
+    try {
+      gameboy->run();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    SDL_Event e = {};
+    e.type = SDL_QUIT;
+    SDL_PushEvent(&e);
+  });
+
+  SDL_Event e;
+  while (SDL_WaitEvent(&e) && e.type != SDL_QUIT) {
+    rewinding = SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE] != 0;
+
+    if (e.type == frameEvent) {
+      framePending = false;
+      present();
+    }
+  }
+
+  quit = true;
+  emulator.join();
+
+  // Rethrown here, as if the GameBoy had run on this thread.
+  if (error) std::rethrow_exception(error);
+}
+
+void Frontend::onFrame(void *context) {
+  Frontend &frontend = *(Frontend *)context;
+
+  if (frontend.quit) {
+    frontend.gameboy->isRunning = false;
+    return;
+  }
+
+  if (frontend.rewinding)
+    frontend.rewindBuffer.rewind(*frontend.gameboy);
+  else
+    frontend.rewindBuffer.push(*frontend.gameboy);
+
+  if (frontend.gameboy->getPC() > 0x0100) {
+    std::lock_guard<std::mutex> lock(frontend.debugViewMutex);
+    frontend.drawTilesetDisplay();
+    frontend.drawTilemapDisplay();
+  }
+
+  if (!frontend.framePending.exchange(true)) {
+    SDL_Event e = {};
+    e.type = frontend.frameEvent;
+    SDL_PushEvent(&e);
+  }
+}
+
+// Selects colors[index] with masks instead of a table lookup so the loop
+// vectorizes.
+static void resolvePalette(const uint8_t *indices, uint32_t *out, int count,
+                           const uint32_t colors[4]) {
+  uint32_t lowDiff = colors[0] ^ colors[1];
+  uint32_t highDiff = colors[2] ^ colors[3];
+
+  for (int i = 0; i < count; ++i) {
+    uint32_t bit0 = -uint32_t(indices[i] & 1);
+    uint32_t bit1 = -uint32_t(indices[i] >> 1);
+    uint32_t low = colors[0] ^ (bit0 & lowDiff);
+    uint32_t high = colors[2] ^ (bit0 & highDiff);
+    out[i] = low ^ (bit1 & (low ^ high));
+  }
+}
+
+// Converts the latest frame to RGBA and hands it to SDL, which scales the
+// texture up to the window, then shows the debug views as last drawn.
+void Frontend::present() {
+  const uint8_t *frame = gameboy->getDisplay().frameBuffer();
+  uint32_t *pixels = (uint32_t *)screen->pixelBuffer;
+  resolvePalette(frame, pixels, Display::SCREEN_WIDTH * Display::SCREEN_HEIGHT,
+                 colors);
+  screen->render();
+
+  {
+    std::lock_guard<std::mutex> lock(debugViewMutex);
+    tilesetDisplay->update();
+    tilemapDisplay->update();
+  }
+
+  tilesetDisplay->present();
+  tilemapDisplay->present();
+}
+
+// Draws the 32x32 background map selected by LCDC bit 3. Nothing is redrawn
+// unless VRAM or the map and tile data selection changed since last time.
+void Frontend::drawTilemapDisplay() {
+  TileCache &tiles = gameboy->getTileCache();
+  uint8_t LCDC = gameboy->peekByte(0xFF40) & 0x18;
+
+  if (tiles.version() != tilemapVersion || LCDC != tilemapLCDC) {
+    tilemapVersion = tiles.version();
+    tilemapLCDC = LCDC;
+    uint16_t mapAddr = PPU::backgroundMapAddress(LCDC);
+    uint32_t *pixels = (uint32_t *)tilemapDisplay->pixelBuffer;
+
+    for (int tileRow = 0; tileRow < 32; ++tileRow) {
+      for (int tileCol = 0; tileCol < 32; ++tileCol) {
+        int tileNumber = tileRow * 32 + tileCol;
+        uint16_t tile =
+            PPU::tileIndex(LCDC, gameboy->peekByte(mapAddr + tileNumber));
+        int tileOffset = tileRow * (256 * 8) + tileCol * 8;
+
+        for (int tilePixelRow = 0; tilePixelRow < 8; ++tilePixelRow) {
+          const uint8_t *row = tiles.row(tile, tilePixelRow);
+
+          for (int tilePixelCol = 0; tilePixelCol < 8; ++tilePixelCol)
+            pixels[tileOffset + tilePixelRow * 256 + tilePixelCol] =
+                colors[row[tilePixelCol]];
+        }
+      }
+    }
+  }
+}
+
+void Frontend::drawTilesetDisplay() {
+  TileCache &tiles = gameboy->getTileCache();
+
+  if (tiles.version() != tilesetVersion) {
+    tilesetVersion = tiles.version();
+    uint32_t *pixels = (uint32_t *)tilesetDisplay->pixelBuffer;
+    int width = TILE_WIDTH * TILESET_WIDTH;
+
+    for (int k = 0; k < 384; ++k) {
+      for (int row = 0; row < 8; ++row) {
+        const uint8_t *tileRow = tiles.row(k, row);
+
+        for (int col = 0; col < 8; ++col) {
+          int offset = (k / TILESET_WIDTH * 8 + row) * width +
+                       (k % TILESET_WIDTH) * 8 + col;
+          pixels[offset] = colors[tileRow[col]];
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_pixels.h>
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "gameboy.h"
+#include "rewind.h"
+#include "sdldisplay.h"
+
+// SDL windows for a GameBoy: the screen and the tileset and tile map debug
+// views. SDL only supports windows, rendering and events on the main thread
+// (macOS enforces it), so run() keeps those there and emulates on a worker
+// thread, which never waits on the renderer or vsync. Holding Backspace
+// rewinds, a frame at a time.
+class Frontend {
+ public:
+  Frontend(GameBoy *gameboy);
+  ~Frontend();
+
+  // Runs the GameBoy until it stops or the window is closed, showing each
+  // frame as it's finished, and throws whatever GameBoy::run threw. Call from
+  // the main thread.
+  void run();
+
+  SDL_Color palette[4] = {
+      {0xe0, 0xf0, 0xe7, 0xff},  // White
+      {0x8b, 0xa3, 0x94, 0xff},  // Light gray
+      {0x55, 0x64, 0x5a, 0xff},  // Dark gray
+      {0x34, 0x3d, 0x37, 0xff},  // Black
+  };
+
+ private:
+  // Registered as the GameBoy's frame callback, so runs on the worker.
+  static void onFrame(void *context);
+
+  void present();
+  void drawTilesetDisplay();
+  void drawTilemapDisplay();
+
+  GameBoy *gameboy;
+
+  std::unique_ptr<SDL_Display> screen;
+  std::unique_ptr<SDL_Display> tilesetDisplay;
+  std::unique_ptr<SDL_Display> tilemapDisplay;
+
+  // palette as RGBA32 words, in SDL's byte order.
+  uint32_t colors[4];
+
+  // TileCache version (and LCDC selection bits) the views were last drawn
+  // from.
+  uint64_t tilesetVersion = 0;
+  uint64_t tilemapVersion = 0;
+  uint8_t tilemapLCDC = 0;
+
+  // SDL event the worker posts when a frame is done; framePending keeps at
+  // most one in the queue however far emulation runs ahead.
+  uint32_t frameEvent;
+  std::atomic<bool> framePending = false;
+
+  // Input for the worker, read from SDL on the main thread.
+  std::atomic<bool> rewinding = false;
+  std::atomic<bool> quit = false;
+
+  // The worker draws the debug views into their pixel buffers, and the main
+  // thread copies them to SDL.
+  std::mutex debugViewMutex;
+
+  RewindBuffer rewindBuffer;
+
+  static constexpr int SCALE_FACTOR = 2;
+  static constexpr size_t REWIND_BUDGET = 64 << 20;
+
+  // The tileset view shows all 384 tiles, 16 to a row.
+  static constexpr int TILESET_WIDTH = 16;
+  static constexpr int TILESET_HEIGHT = 24;
+  static constexpr int TILE_WIDTH = 8;
+};
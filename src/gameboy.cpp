@@ -1,16 +1,11 @@
 #include "gameboy.h"
 
-#include <SDL.h>
-#include <SDL_events.h>
-#include <SDL_pixels.h>
-#include <SDL_render.h>
-#include <SDL_surface.h>
-#include <SDL_video.h>
 #include <_types/_uint16_t.h>
 #include <_types/_uint64_t.h>
 #include <_types/_uint8_t.h>
 #include <string.h>
 
+#include <algorithm>
 #include <bitset>
 #include <cassert>
 #include <chrono>
@@ -18,26 +13,149 @@
 #include <cstdio>
 #include <cstring>
 #include <fstream>
-#include <iostream>
+#include <iterator>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "cpu.h"
 #include "display.h"
+#include "tilecache.h"
 #include "utils.h"
 
 enum Pixel { WHITE, LIGHT_GRAY, DARK_GRAY, BLACK };
 
-void GameBoy::tick() {
-  ++ticks;
-  if ((ticks % 4) == 0) cpu.tick();
-  if ((cpu.memory->readByte(0xFF40) & 0x80) != 0) ppu.tick();
+// Runs the CPU for a whole instruction (or, when executing cached blocks, up
+// to the next scheduled event or an interrupt coming due), advances the clock
+// by the cycles it took and then handles whatever hardware events came due in
+// the meantime. A halted CPU skips straight to the next event or the
+// deadline, whichever is first, instead: only events raise interrupts, so
+// nothing can wake it before then.
+void GameBoy::tick(uint64_t deadline) {
+  tickStartCycles = cpu.cycles;
+  uint16_t startPC = cpu.PC;
+
+  if (cpu.halted) {
+    uint64_t next = std::min(scheduler.nextEventTime(), deadline);
+    cpu.cycles += next > ticks ? (int)((next - ticks + 3) / 4) : 1;
+  } else if (cpu.getExecutionMode() == CPU::ExecutionMode::CACHED_BLOCKS) {
+    uint64_t next = scheduler.nextEventTime();
+    cpu.runCachedBlock(next > ticks ? (int)((next - ticks + 3) / 4) : 1);
+  } else {
+    cpu.tick();
+  }
+
+  ticks += (uint64_t)(cpu.cycles - tickStartCycles) * 4;
+
+  runEvents();
   handleInterrupts();
+
+  // Loops are the only way back to an earlier address, short of calls.
+  if (idleLoopSkipping && cpu.PC <= startPC && !cpu.halted)
+    skipIdleLoop(deadline);
+}
+
+// Called whenever control moves backwards. If the CPU arrives back at the
+// same address with the same registers, nothing written and no event in
+// between, it's polling: memory can only change through a write or an
+// event, so every pass until the next event repeats this one exactly. Those
+// passes are skipped in one go, stopping short of the pass that sees the
+// event so it runs as it would have anyway. Nor does it skip the pass that
+// reaches the caller's deadline, so a frame (or a run with a tick limit) ends
+// where it would have without skipping.
+void GameBoy::skipIdleLoop(uint64_t deadline) {
+  // The cycle counter moves on every pass; nothing else should.
+  CPU::Snapshot state;
+  cpu.save(state);
+  state.cycles = 0;
+
+  if (cpu.PC == idleLoop.pc && memory.writeCount == idleLoop.writeCount &&
+      eventCount == idleLoop.eventCount && state == idleLoop.cpu &&
+      !memory.hasReadWatches()) {
+    uint64_t passTicks = ticks - idleLoop.ticks;
+    uint64_t next = std::min(scheduler.nextEventTime(), deadline);
+    if (passTicks != 0 && next > ticks) {
+      uint64_t skipped = (next - 1 - ticks) / passTicks * passTicks;
+      ticks += skipped;
+      cpu.cycles += (int)(skipped / 4);
+    }
+  }
+
+  idleLoop = {cpu.PC, ticks, memory.writeCount, eventCount, state};
+}
+
+// Lets the PPU draw up to the instruction making the write. The CPU counts an
+// instruction's cycles before running it, so this is when it ends.
+void GameBoy::onVideoWrite(void *context) {
+  GameBoy &gameboy = *(GameBoy *)context;
+  int cycles = gameboy.cpu.cycles - gameboy.tickStartCycles;
+  gameboy.ppu.catchUp(gameboy.ticks + (uint64_t)cycles * 4);
+}
+
+// Schedules the first PPU mode change and divider tick. The timer counter is
+// scheduled by the divider once TAC enables it.
+void GameBoy::startScheduler() {
+  ticks = 0;
+  scheduler.clear();
+  scheduler.schedule(SchedulerEvent::PPU, PPU::OAM_SCAN_DOTS);
+  scheduler.schedule(SchedulerEvent::DIVIDER, Timer::DIVIDER_PERIOD);
+}
+
+// Processes every scheduled event due by now. Events are rescheduled relative
+// to the time they were due, not the time they were handled, so the CPU
+// overshooting a deadline by part of an instruction never accumulates drift.
+void GameBoy::runEvents() {
+  SchedulerEvent event;
+  uint64_t timestamp;
+
+  while (scheduler.popDue(ticks, event, timestamp)) {
+    ++eventCount;
+    switch (event) {
+      case SchedulerEvent::PPU: {
+        // The PPU is frozen while the LCD is off; check again a line later.
+        if ((memory.memory[0xFF40] & 0x80) == 0) {
+          scheduler.schedule(event, timestamp + PPU::DOTS_PER_LINE);
+          break;
+        }
+
+        scheduler.schedule(event, timestamp + ppu.step(timestamp));
+        break;
+      }
+
+      case SchedulerEvent::DIVIDER: {
+        timer.tickDivider();
+        scheduler.schedule(event, timestamp + Timer::DIVIDER_PERIOD);
+
+        // TAC is polled here, so starting the timer takes effect within one
+        // divider period.
+        if (timer.isRunning() && !scheduler.isScheduled(SchedulerEvent::TIMER))
+          scheduler.schedule(SchedulerEvent::TIMER,
+                             timestamp + timer.getPeriod());
+        break;
+      }
+
+      case SchedulerEvent::TIMER: {
+        // A stopped timer is re-armed by the divider.
+        if (!timer.isRunning()) break;
+
+        timer.tickCounter();
+        scheduler.schedule(event, timestamp + timer.getPeriod());
+        break;
+      }
+
+      case SchedulerEvent::COUNT:
+        break;
+    }
+  }
 }
 
 // Check if any interrupt flags are set and handle them accordingly.
 void GameBoy::handleInterrupts() {
-  uint8_t interruptsFired = memory.readByte(0xFFFF) & memory.readByte(0xFF0F);
+  uint8_t interruptsFired = memory.memory[0xFFFF] & memory.memory[0xFF0F];
+
+  // Any requested interrupt ends HALT, even with IME off, in which case the
+  // CPU carries on after the HALT without servicing it.
+  if ((interruptsFired & 0x1F) != 0) cpu.halted = false;
 
   if (cpu.IME && interruptsFired > 0) {
     if (interruptsFired & 0x01) {
@@ -103,41 +221,59 @@ void GameBoy::joypadInterruptHandler() {
 }
 
 void GameBoy::run() {
-  loadBootRom();
+  if (!poweredOn) powerOn();
   isRunning = true;
-  ticks = 0;
+  frameTimes.clear();
 
-  SDL_Event e;
-  while (SDL_PollEvent(&e))
-    if (e.type == SDL_QUIT) isRunning = false;
-
-  uint64_t tickInterval = getTimeNanoseconds();
-  uint64_t ioInterval = tickInterval;
-  uint64_t renderTileDisplayInterval = tickInterval;
+  uint64_t startTime = getTimeNanoseconds();
+  uint64_t ioInterval = startTime;
+  uint64_t deadline = startTime;
 
   while (isRunning) {
-    uint64_t currentTime = getTimeNanoseconds();
+    uint64_t frameStart = getTimeNanoseconds();
 
-    if ((currentTime - tickInterval) >=
-        (CLOCK_CYCLE_DURATION_NANOSECONDS - 50)) {
-      tick();
-      tickInterval = currentTime;
-    }
+    runFrame();
+
+    if (frameCallback != NULL) frameCallback(frameCallbackContext);
 
-    if ((currentTime - ioInterval) >= ONE_SECOND_MICROSECONDS) {
+    if ((frameStart - ioInterval) >= ONE_SECOND_MICROSECONDS) {
       // printf("FPS: %llu\n", ppu.display.frames);
       ppu.display.frames = 0;
-      ioInterval = currentTime;
+      ioInterval = frameStart;
     }
 
-    if ((currentTime - renderTileDisplayInterval) >= _60FPS_INTERVAL &&
-        cpu.PC > 0x0100) {
-      renderTilesetDisplay();
-      renderTilemapDisplay();
-      renderTileDisplayInterval = currentTime;
-    }
+    if (speed == 0) continue;
+
+    // Sleep until the frame's deadline. Deadlines advance by a fixed period
+    // from the previous deadline rather than from when we woke up, so sleep
+    // overshoot never accumulates. After a stall of more than MAX_FRAME_LAG
+    // frames, resynchronise instead of racing to catch up.
+    uint64_t frameDuration = (uint64_t)(FRAME_DURATION_NANOSECONDS / speed);
+    uint64_t currentTime = getTimeNanoseconds();
+    deadline += frameDuration;
 
-    // timer.run(cpu.cycles);
+    bool late = currentTime > deadline;
+    frameTimes.record(currentTime - frameStart, late);
+
+    if (!late)
+      std::this_thread::sleep_for(
+          std::chrono::nanoseconds(deadline - currentTime));
+    else if (currentTime - deadline > MAX_FRAME_LAG * frameDuration)
+      deadline = currentTime;
+  }
+
+  if (speed != 0) frameTimes.print();
+}
+
+// Emulates up to the end of the current frame (every CYCLES_PER_FRAME
+// T-cycles since the run started), or until the run is stopped or reaches
+// its tick limit.
+void GameBoy::runFrame() {
+  uint64_t frameEnd = (ticks / CYCLES_PER_FRAME + 1) * CYCLES_PER_FRAME;
+  if (tickLimit != 0) frameEnd = std::min(frameEnd, tickLimit);
+
+  while (isRunning && ticks < frameEnd) {
+    tick(frameEnd);
 
     // printf("%04X : %02X %02X %02X %02X\n", cpu.getPC(),
     // memory.readByte(0xFF04),
@@ -145,104 +281,116 @@ void GameBoy::run() {
     //        memory.readByte(0xFF07));
     // getchar();
 
-    cpu.cycles = 0;
-
-    if (endpoint != 0 && cpu.PC == endpoint) break;
+    if (endpoint != 0 && cpu.PC == endpoint) isRunning = false;
   }
-}
 
-void GameBoy::renderTilemapDisplay() {
-  for (int tileRow = 0; tileRow < 32; ++tileRow) {
-    for (int tileCol = 0; tileCol < 32; ++tileCol) {
-      int tileNumber = tileRow * 32 + tileCol;
-      uint16_t addr = 0x9C00 + (tileNumber * 16);
-      int tileOffset = tileRow * (256 * 8 * 4) + tileCol * 32;
-
-      for (int tilePixelRow = 0; tilePixelRow < 8; ++tilePixelRow) {
-        uint8_t byte1 = memory.memory[addr + tilePixelRow * 2];
-        uint8_t byte2 = memory.memory[addr + tilePixelRow * 2 + 1];
-
-        for (int tilePixelCol = 0; tilePixelCol < 8; ++tilePixelCol) {
-          uint8_t mask = 1 << (7 - tilePixelCol);
-          uint8_t lsb = byte1 & mask;
-          uint8_t msb = byte2 & mask;
+  if (tickLimit != 0 && ticks >= tickLimit) isRunning = false;
+  cpu.cycles = 0;
+}
 
-          int pixel = 0 | (lsb != 0 ? 1 : 0) << 1 | (msb != 0 ? 1 : 0);
+static std::vector<uint8_t> readFile(const char* filename) {
+  std::ifstream file(filename, std::ios::binary);
 
-          int pixelOffset =
-              tileOffset + (tilePixelRow * 256 * 4) + (tilePixelCol * 4);
+  if (!file.is_open())
+    throw std::runtime_error("Failed to read file from : " +
+                             std::string(filename));
 
-          memcpy(&tilemapDisplay.pixelBuffer[pixelOffset],
-                 &ppu.display.palette[pixel], sizeof(SDL_Color));
-        }
-      }
-    }
-  }
-  tilemapDisplay.render();
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
 }
 
-void GameBoy::renderTilesetDisplay() {
-  for (int k = 0; k < 384; ++k) {
-    uint16_t addr = 0x8000 + (k * 16);
-
-    for (int row = 0; row < 8; ++row) {
-      uint8_t byte1 = memory.readByte(addr + (row * 2));
-      uint8_t byte2 = memory.readByte(addr + (row * 2) + 1);
+// Map a cartridge image and its banks into memory
+void GameBoy::loadRom(const char* filename) {
+  std::shared_ptr<RomImage> rom = RomImage::open(filename);
 
-      for (int col = 0; col < 8; ++col) {
-        uint8_t mask = 1 << (7 - col);
-        uint8_t lsb = byte1 & mask;
-        uint8_t msb = byte2 & mask;
+  if (rom == NULL)
+    throw std::runtime_error("Failed to read file from : " +
+                             std::string(filename));
 
-        SDL_Color pixel =
-            ppu.display
-                .palette[0 | (lsb != 0 ? 1 : 0) << 1 | (msb != 0 ? 1 : 0)];
+  loadRom(rom);
+}
 
-        int offset = ((int)(k / 16) * 512 * 8) + (512 * row) +
-                     ((k % 16) * 8 * 4) + (4 * col);
+// Throws if the cartridge type isn't supported.
+void GameBoy::loadRom(std::shared_ptr<RomImage> rom) {
+  cartridge = std::make_unique<Cartridge>(rom);
+  memory.insertCartridge(cartridge.get());
+}
 
-        memcpy(&tilesetDisplay.pixelBuffer[offset], &pixel, sizeof(SDL_Color));
-      }
-    }
-  }
+void GameBoy::powerOn() {
+  loadBootRom();
+  startScheduler();
+  poweredOn = true;
+}
 
-  tilesetDisplay.render();
+void GameBoy::saveState(SaveState &state) {
+  state.magic = SaveState::MAGIC;
+  state.version = SaveState::VERSION;
+  state.romHash = cartridge != NULL ? cartridge->getRomHash() : 0;
+  state.ticks = ticks;
+
+  cpu.save(state.cpu);
+  if (cartridge != NULL) cartridge->save(state.cartridge);
+  memory.save(state.memory);
+  ppu.save(state.ppu);
+  scheduler.save(state.scheduler);
 }
 
-// Load rom file into memory starting at the address referenced by the
-// current PC
-void GameBoy::loadRom(const char* filename, uint16_t addr,
-                      bool shouldUpdateRomData) {
-  std::fstream romFile(filename);
+void GameBoy::loadState(const SaveState &state) {
+  if (state.magic != SaveState::MAGIC || state.version != SaveState::VERSION)
+    throw std::runtime_error("Unsupported save state version");
+  if (state.romHash != (cartridge != NULL ? cartridge->getRomHash() : 0))
+    throw std::runtime_error("Save state is for a different cartridge");
+
+  // The boot ROM's contents aren't part of the state.
+  if (state.memory.bootRomMapped && !poweredOn) loadBootRom();
+  poweredOn = true;
+  ticks = state.ticks;
+
+  cpu.load(state.cpu);
+  if (cartridge != NULL) cartridge->load(state.cartridge);
+  memory.load(state.memory);
+  ppu.load(state.ppu);
+  ppu.tileCache.invalidateAll();
+  scheduler.load(state.scheduler);
+
+  // Anything may have changed, as after an event.
+  ++eventCount;
+}
 
-  if (!romFile.is_open()) {
-    std::cerr << "Failed to read rom file from : " << BOOT_ROM_FILEPATH
-              << std::endl;
-    exit(1);
+std::unique_ptr<GameBoy> GameBoy::fork() {
+  std::unique_ptr<GameBoy> child = std::make_unique<GameBoy>();
+  child->speed = speed;
+  child->endpoint = endpoint;
+  child->tickLimit = tickLimit;
+  child->setExecutionMode(cpu.getExecutionMode());
+  child->setRenderer(ppu.getRenderer());
+
+  if (cartridge != NULL) {
+    child->cartridge = std::make_unique<Cartridge>(*cartridge);
+    child->memory.insertCartridge(child->cartridge.get());
   }
+  memory.fork(child->memory);
 
-  cpu.setPC(addr);
-  while (romFile) {
-    memory.writeByte(cpu.getPC(), romFile.get());
-    if (shouldUpdateRomData) romData.push_back(memory.readByte(cpu.getPC()));
-    // printf("0x%04X: 0x%02X\n", cpu.getPC(),
-    // memory.readByte(cpu.getPC()));
-    cpu.incrementPC();
-  }
+  CPU::Snapshot cpuState;
+  cpu.save(cpuState);
+  child->cpu.load(cpuState);
 
-  if (shouldUpdateRomData) {
-    cpu.setRomData(romData);
-  }
+  PPU::Snapshot ppuState;
+  ppu.save(ppuState);
+  child->ppu.load(ppuState);
 
-  romFile.close();
-  // printf("Loaded rom file: %s\n", filename);
+  Scheduler::Snapshot schedulerState;
+  scheduler.save(schedulerState);
+  child->scheduler.load(schedulerState);
+
+  child->ticks = ticks;
+  child->poweredOn = poweredOn;
+  return child;
 }
 
 void GameBoy::loadBootRom() {
-  loadRom(BOOT_ROM_FILEPATH.c_str(), 0x0000, false);
+  memory.mapBootRom(readFile(BOOT_ROM_FILEPATH.c_str()));
   cpu.setPC(0x0000);
-
-  // printf("Loaded boot rom file.\n");
 }
 
 void GameBoy::setEndpoint(uint16_t addr) { endpoint = addr; }
@@ -6,38 +6,52 @@
 #include <sys/_types/_u_int16_t.h>
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "cartridge.h"
 #include "cpu.h"
 #include "events.h"
+#include "frametime.h"
 #include "mem.h"
 #include "ppu.h"
+#include "savestate.h"
+#include "scheduler.h"
+#include "tilecache.h"
 #include "timer.h"
 #include "utils.h"
 
 const std::string BOOT_ROM_FILEPATH = "./roms/dmg_boot.bin";
-const uint64_t CLOCK_CYCLE_DURATION_NANOSECONDS = 238;
 const uint64_t ONE_SECOND_MICROSECONDS = 1000000000;
-const uint64_t _60FPS_INTERVAL = 16666666;
 
-#define TILESET_HEIGHT 24
-#define TILESET_WIDTH 16
-#define TILE_WIDTH 8
+// One frame is 154 scanlines of 456 dots, ~16.74ms (59.73Hz) at 4.194304MHz.
+const uint64_t CYCLES_PER_FRAME = 70224;
+const uint64_t FRAME_DURATION_NANOSECONDS = 16742706;
+const uint64_t MAX_FRAME_LAG = 4;
+
+// Called by run() after every emulated frame, e.g. to let a frontend handle
+// its windows.
+typedef void (*FrameCallback)(void *context);
 
 class GameBoy {
  public:
-  GameBoy()
-      : cpu(&memory),
-        ppu(&memory),
-        timer(&memory),
-        tilesetDisplay("Tileset", SCREEN_WIDTH, SCREEN_HEIGHT, PIXEL_WIDTH,
-                       false),
-        tilemapDisplay("Tilemap", 256, 256, 1, true){};
-
-  ~GameBoy() { SDL_Quit(); }
+  // The emulator core opens no windows; see Frontend for the SDL ones. Runs
+  // in real time unless given another speed with setSpeed.
+  GameBoy() : cpu(&memory), ppu(&memory), timer(&memory), speed(1) {
+    // Memory is constructed after the PPU, so the cache is attached here.
+    memory.setTileCache(&ppu.tileCache);
+    memory.setVideoWriteCallback(onVideoWrite, this);
+  };
 
-  void tick();
+  // Neither HALT nor idle loops (see setIdleLoopSkipping) are skipped past
+  // deadline, in T-cycles.
+  void tick(uint64_t deadline = UINT64_MAX);
+  // Powers on first if need be, which throws if the boot ROM (at
+  // BOOT_ROM_FILEPATH) can't be read.
   void run();
+  void runFrame();
+  void runEvents();
   void reset();
 
   void handleInterrupts();
@@ -49,36 +63,114 @@ class GameBoy {
   void joypadInterruptHandler();
 
   void updateTimer();
-  void loadRom(const char *filename, uint16_t addr, bool shouldUpdateRomData);
-  void renderTilesetDisplay();
-  void renderTilemapDisplay();
+  // Both throw if the ROM can't be read or its cartridge type isn't
+  // supported.
+  void loadRom(const char *filename);
+  void loadRom(std::shared_ptr<RomImage> rom);
   void setEndpoint(uint16_t addr);
+  // Stops run() once this many T-cycles have been emulated (0 for no limit).
+  void setTickLimit(uint64_t limit) { tickLimit = limit; };
+
+  // Captures the whole machine without allocating, e.g. from the frame
+  // callback.
+  void saveState(SaveState &state);
+  // Continues from a state saved with the same cartridge; a following run()
+  // resumes from it instead of booting. Throws if the state was written by
+  // another version or for another cartridge.
+  void loadState(const SaveState &state);
+
+  // A new GameBoy continuing from this one's current state, e.g. to try
+  // several inputs from the same point. The two share the ROM, and RAM until
+  // either writes to it (see Memory::fork). The child has no frame callback
+  // or watches and can run on another thread, but fork must not be called
+  // while this one is running elsewhere.
+  std::unique_ptr<GameBoy> fork();
+
+  // Emulation speed as a multiple of real time; 0 runs unthrottled.
+  void setSpeed(double multiplier) { speed = multiplier; };
+
+  // T-cycles emulated since run() started.
+  uint64_t getTicks() { return ticks; };
+
+  // Time taken to emulate each frame when running with a speed set.
+  FrameTimeHistogram &getFrameTimes() { return frameTimes; };
+  void setExecutionMode(CPU::ExecutionMode mode) {
+    cpu.setExecutionMode(mode);
+  };
+  void setRenderer(PPU::Renderer renderer) { ppu.setRenderer(renderer); };
 
-  const int PIXEL_WIDTH = 1;
-  const int SCREEN_WIDTH = TILE_WIDTH * TILESET_WIDTH;
-  const int SCREEN_HEIGHT = TILE_WIDTH * TILESET_HEIGHT;
+  // Fast-forwards through loops that only poll memory, such as waiting for LY
+  // to reach a line, to just before the next scheduled event or the end of
+  // the frame, whichever comes first. On by default; emulation is exactly the
+  // same with it off, only slower.
+  void setIdleLoopSkipping(bool enabled) { idleLoopSkipping = enabled; };
 
-  void addEventListener(GameboyEventType eventType,
-                        GameboyEventCallback callback) {
-    memory.addEventListener(eventType, callback);
+  void setFrameCallback(FrameCallback callback, void *context) {
+    frameCallback = callback;
+    frameCallbackContext = context;
   };
 
-  bool isRunning;
+  // The last finished frame as Display::SCREEN_WIDTH x SCREEN_HEIGHT palette
+  // indices (0-3). See Display::frameBuffer.
+  const uint8_t *getFrameBuffer() { return ppu.display.frameBuffer(); };
+
+  // For frontends and debug views.
+  Display &getDisplay() { return ppu.display; };
+  TileCache &getTileCache() { return ppu.tileCache; };
+  uint8_t peekByte(uint16_t address) { return memory.peekByte(address); };
+  uint16_t getPC() { return cpu.getPC(); };
+
+  void addWatch(GameboyEventType eventType, uint16_t start, uint16_t end,
+                GameboyEventCallback callback, void *context) {
+    memory.addWatch(eventType, start, end, callback, context);
+  };
+
+  bool isRunning = false;
 
  private:
   CPU cpu;
   PPU ppu;
   Memory memory;
   Timer timer;
+  Scheduler scheduler;
 
+  void powerOn();
+  void skipIdleLoop(uint64_t deadline);
+  static void onVideoWrite(void *context);
   void loadBootRom();
+  void startScheduler();
+
+  // Set once the boot ROM is mapped and the clock started, by run() or by
+  // loading a state.
+  bool poweredOn = false;
+
+  std::unique_ptr<Cartridge> cartridge;
 
-  std::vector<uint8_t> romData;
+  // T-cycles emulated since run() started, up to the start of the current
+  // tick; the CPU's cycle counter then stood at tickStartCycles.
+  uint64_t ticks = 0;
+  int tickStartCycles = 0;
+
+  // Scheduled events handled so far.
+  uint64_t eventCount = 0;
+
+  // The machine the last time the CPU jumped back to `pc`, see skipIdleLoop.
+  struct IdleLoop {
+    uint16_t pc;
+    uint64_t ticks;
+    uint64_t writeCount;
+    uint64_t eventCount;
+    CPU::Snapshot cpu;
+  };
+  IdleLoop idleLoop = {};
+  bool idleLoopSkipping = true;
 
-  uint64_t ticks;
+  double speed;
+  FrameTimeHistogram frameTimes;
 
-  SDL_Display tilesetDisplay;
-  SDL_Display tilemapDisplay;
+  FrameCallback frameCallback = NULL;
+  void *frameCallbackContext = NULL;
 
   uint16_t endpoint = 0;
+  uint64_t tickLimit = 0;
 };
@@ -1,26 +1,133 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "batch.h"
+#include "bench.h"
+#include "frontend.h"
 #include "gameboy.h"
 #include "test.h"
 
 // #define TEST
+// #define BENCHMARK
+
+#if !defined(TEST) && !defined(BENCHMARK)
+// Prints one line per ROM and returns non-zero unless every ROM passed.
+static int runBatch(const std::vector<std::string> &romPaths, size_t jobs,
+                    double seconds) {
+  BatchRunner runner(jobs);
+  uint64_t start = getTimeNanoseconds();
+  std::vector<BatchResult> results =
+      runner.run(romPaths, (uint64_t)(seconds * 4194304));
+  uint64_t elapsed = getTimeNanoseconds() - start;
+
+  int passed = 0;
+  for (const BatchResult &result : results) {
+    const char *status = !result.error.empty() ? "ERROR"
+                         : !result.finished    ? "TIMEOUT"
+                         : result.passed       ? "PASSED"
+                                               : "FAILED";
+    printf("%-8s %7.2fs %8.2fs emulated  %s %s\n", status,
+           result.nanoseconds / 1e9, result.cycles / 4194304.0,
+           result.romPath.c_str(), result.error.c_str());
+    if (result.passed) ++passed;
+  }
+
+  printf("%d/%zu passed in %.2fs on %zu threads\n", passed, results.size(),
+         elapsed / 1e9, runner.getThreadCount());
+  return passed == (int)results.size() ? 0 : 1;
+}
+#endif
 
 int main(int argc, char *argv[]) {
 #ifdef TEST
-  runBlarggTests();
+  // Run every ROM under both execution modes so the block cache can be
+  // cross-checked against the interpreter.
+  runBlarggTests(CPU::ExecutionMode::INTERPRETER);
+  runBlarggTests(CPU::ExecutionMode::CACHED_BLOCKS);
+  runInterruptTimingTest();
+#endif
+
+#ifdef BENCHMARK
+  runTileDecodeBenchmark();
+  runCBBenchmark();
 #endif
 
-#ifndef TEST
+#if !defined(TEST) && !defined(BENCHMARK)
+  // --headless runs without windows and unthrottled; --speed sets the speed
+  // as a multiple of real time (0 for unthrottled); --scanline draws each line
+  // in one pass, which is faster but misses writes made while the line is
+  // drawn, instead of dot by dot through the pixel FIFO; --no-idle-skip runs
+  // idle loops pass by pass. --batch runs every ROM given headless, on --jobs
+  // threads, for at most --seconds of emulated time each.
+  bool headless = false;
+  bool scanline = false;
+  bool batch = false;
+  bool idleLoopSkipping = true;
+  double speed = -1;
+  size_t jobs = 0;
+  double seconds = 60;
+  const char *romPath = NULL;
+  std::vector<std::string> romPaths;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+
+    if (arg == "--headless")
+      headless = true;
+    else if (arg == "--scanline")
+      scanline = true;
+    else if (arg == "--no-idle-skip")
+      idleLoopSkipping = false;
+    else if (arg == "--batch")
+      batch = true;
+    else if (arg == "--speed" && i + 1 < argc)
+      speed = atof(argv[++i]);
+    else if (arg == "--jobs" && i + 1 < argc)
+      jobs = atoi(argv[++i]);
+    else if (arg == "--seconds" && i + 1 < argc)
+      seconds = atof(argv[++i]);
+    else {
+      romPath = argv[i];
+      romPaths.push_back(arg);
+    }
+  }
+
+  if (batch) return runBatch(romPaths, jobs, seconds);
+
   GameBoy gb = GameBoy();
+  if (speed >= 0)
+    gb.setSpeed(speed);
+  else if (headless)
+    gb.setSpeed(0);
+  if (scanline) gb.setRenderer(PPU::Renderer::SCANLINE);
+  gb.setIdleLoopSkipping(idleLoopSkipping);
+
+  std::unique_ptr<Frontend> frontend;
+  if (!headless) frontend = std::make_unique<Frontend>(&gb);
 
-  if (argc != 2)
-    printf(
-        "Running without ROM! Correct usage is:\n\tgameboy <ROM "
-        "filepath>\n");
+  try {
+    if (romPath == NULL)
+      printf(
+          "Running without ROM! Correct usage is:\n\tgameboy [--headless] "
+          "[--speed <multiplier>] [--scanline] [--no-idle-skip] <ROM "
+          "filepath>\n\tgameboy --batch [--jobs <threads>] [--seconds "
+          "<limit>] <ROM filepath>...\n");
 
-  else
-    gb.loadRom(argv[1], 0x0000, true);
+    else
+      gb.loadRom(romPath);
 
-  gb.run();
+    if (frontend)
+      frontend->run();
+    else
+      gb.run();
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
 #endif
 }
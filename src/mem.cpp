@@ -5,63 +5,320 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
+#include "blockcache.h"
 #include "events.h"
 #include "utils.h"
 
-uint8_t Memory::readByte(uint16_t address) {
-  if (address >= MEM_SIZE) return 0x0aa;
-  uint8_t value = memory[address];
+uint8_t Memory::peekByte(uint16_t address) {
+  uint8_t* page = pages[address >> 8];
+  if (page != NULL) return page[address & 0xFF];
 
-  if (listeners[GameboyEventType::MEM_READ_BYTE].size() > 0) {
-    for (auto callback : listeners[GameboyEventType::MEM_READ_BYTE])
-      callback({.memory = {address, value, 0, memory}});
-  }
+  if (cartridge != NULL && address >= 0xA000 && address < 0xC000)
+    return cartridge->readRam(address);
 
-  return value;
+  if (address >= MEM_SIZE) return 0x0aa;
+  return memory[address];
 }
 
-uint16_t Memory::readWord(uint16_t address) {
-  uint16_t value = (uint16_t)readByte(address + 1) << 8 | readByte(address);
+uint8_t Memory::readIO(uint16_t address) {
+  uint8_t value = peekByte(address);
 
-  if (listeners[GameboyEventType::MEM_READ_WORD].size() > 0) {
-    for (auto callback : listeners[GameboyEventType::MEM_READ_WORD])
-      callback({.memory = {address, 0, value, memory}});
-  }
+  if (isWatched(GameboyEventType::MEM_READ_BYTE, address))
+    notify(GameboyEventType::MEM_READ_BYTE,
+           {.memory = {address, value, 0, memory}});
 
   return value;
 }
 
-void Memory::writeByte(uint16_t address, uint8_t value) {
-  writeByte(address, value, true);
+void Memory::writeByte(uint16_t address, uint8_t value, bool triggerListener) {
+  ++writeCount;
+  uint8_t* page = writePages[address >> 8];
+  if (page != NULL)
+    page[address & 0xFF] = value;
+  else
+    writeIO(address, value, triggerListener);
 }
 
-void Memory::writeByte(uint16_t address, uint8_t value, bool triggerListener) {
+void Memory::writeIO(uint16_t address, uint8_t value, bool triggerListener) {
   if (address == 0xFF04) value = 0;
 
-  if (triggerListener &&
-      listeners[GameboyEventType::MEM_WRITE_BYTE].size() > 0) {
-    for (auto callback : listeners[GameboyEventType::MEM_WRITE_BYTE])
-      callback({.memory = {address, value, 0, memory}});
-  }
+  if (triggerListener && isWatched(GameboyEventType::MEM_WRITE_BYTE, address))
+    notify(GameboyEventType::MEM_WRITE_BYTE,
+           {.memory = {address, value, 0, memory}});
 
   if (!shouldWriteToMemory) {
     mem_accesses[num_mem_accesses] =
         mem_access{MEM_ACCESS_WRITE, address, value};
     ++num_mem_accesses;
-  } else {
-    memory[address] = value;
+    return;
+  }
+
+  if (cartridge != NULL && address < 0x8000) {
+    cartridge->writeRegister(address, value);
+    mapCartridge();
+    return;
   }
+
+  // LY is read-only; the PPU relies on it staying within 0-153.
+  if (address == 0xFF44) return;
+
+  if (address == 0xFF0F || address == 0xFFFF) interruptCheck = true;
+
+  bool isVideo = (address >= 0x8000 && address < 0xA000) ||
+                 (address >= 0xFE00 && address < 0xFEA0) ||
+                 (address >= 0xFF40 && address <= 0xFF4B);
+  if (isVideo && videoWriteCallback != NULL)
+    videoWriteCallback(videoWriteContext);
+
+  if (address == 0xFF50 && value != 0 && bootRomMapped) unmapBootRom();
+  if (address == 0xFF46) copyToOAM(value);
+
+  uint8_t* page = pages[address >> 8];
+  if (page != NULL && isShared(address >> 8)) page = unshare(address >> 8);
+  if (page != NULL && !readOnlyPages[address >> 8])
+    page[address & 0xFF] = value;
+  else if (cartridge != NULL && address >= 0xA000 && address < 0xC000)
+    cartridge->writeRam(address, value);
+  else if (address < MEM_SIZE)
+    memory[address] = value;
+
+  if (blockCache != NULL) blockCache->invalidate(address);
+  if (tileCache != NULL && address >= 0x8000 && address < 0xA000)
+    tileCache->invalidate(address);
 }
 
 void Memory::writeWord(uint16_t address, uint16_t value) {
   if (address == 0xFF04) value = 0;
 
-  if (listeners[GameboyEventType::MEM_WRITE_WORD].size() > 0) {
-    for (auto callback : listeners[GameboyEventType::MEM_WRITE_WORD])
-      callback({.memory = {address, 0, value, memory}});
-  }
+  if (wordWatchCount != 0 &&
+      isWatched(GameboyEventType::MEM_WRITE_WORD, address))
+    notify(GameboyEventType::MEM_WRITE_WORD,
+           {.memory = {address, 0, value, memory}});
 
   writeByte(address + 1, (uint8_t)((value & 0xFF00) >> 8), false);
   writeByte(address, (uint8_t)(value & 0x00FF), false);
 }
+
+void Memory::mapPages() {
+  for (size_t page = 0; page < 0x100; ++page)
+    mapRange((uint8_t)page, 1, homePage((uint8_t)page), false);
+
+  if (cartridge != NULL)
+    mapCartridge();
+  else if (bootRomMapped)
+    mapRange(0x00, 1, bootRom.data(), true);
+
+  for (size_t page = 0; page < 0x100; ++page) updatePage((uint8_t)page);
+}
+
+// Points `count` pages starting at firstPage at consecutive 256-byte chunks
+// of base (or at nothing if base is NULL). Pages whose backing changes lose
+// their cached code.
+void Memory::mapRange(uint8_t firstPage, size_t count, uint8_t* base,
+                      bool readOnly) {
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t page = firstPage + i;
+    uint8_t* backing = base != NULL ? base + i * 0x100 : NULL;
+    if (pages[page] == backing && readOnlyPages[page] == readOnly) continue;
+
+    pages[page] = backing;
+    readOnlyPages[page] = readOnly;
+    if (codePages[page] && blockCache != NULL)
+      blockCache->invalidatePage(page);
+    updatePage(page);
+  }
+}
+
+void Memory::mapCartridge() {
+  // ROM may be a read-only mapping of the file. Read-only pages never get a
+  // write pointer, so dropping const here is safe.
+  uint8_t* bank0 = const_cast<uint8_t*>(cartridge->romBank0());
+  uint8_t* bankN = const_cast<uint8_t*>(cartridge->romBankN());
+
+  mapRange(0x00, 1, bootRomMapped ? bootRom.data() : bank0, true);
+  mapRange(0x01, 0x3F, bank0 + 0x100, true);
+  mapRange(0x40, 0x40, bankN, true);
+  mapRange(0xA0, 0x20, cartridge->ramBank(), false);
+}
+
+// OAM DMA copies 160 bytes from XX00-XX9F into OAM. The transfer is done at
+// once rather than over 160 machine cycles.
+void Memory::copyToOAM(uint8_t source) {
+  for (uint16_t i = 0; i < 0xA0; ++i)
+    memory[0xFE00 + i] = peekByte((uint16_t)(source << 8 | i));
+}
+
+void Memory::insertCartridge(Cartridge* c) {
+  cartridge = c;
+  mapPages();
+}
+
+void Memory::mapBootRom(std::vector<uint8_t> rom) {
+  rom.resize(0x100, 0xFF);
+  bootRom = std::move(rom);
+  bootRomMapped = true;
+  mapPages();
+}
+
+void Memory::unmapBootRom() {
+  bootRomMapped = false;
+
+  if (cartridge != NULL)
+    mapCartridge();
+  else
+    mapRange(0x00, 1, homePage(0x00), false);
+}
+
+// Where a page lives when nothing is mapped over it: its shared copy if it
+// has one, else its part of `memory`.
+uint8_t* Memory::homePage(uint8_t page) {
+  if (sharedPages[page] != NULL) return sharedPages[page].get();
+  bool backed = memory != NULL && (size_t)(page + 1) * 0x100 <= MEM_SIZE;
+  return backed ? memory + page * 0x100 : NULL;
+}
+
+void Memory::save(Snapshot& snapshot) {
+  memcpy(snapshot.memory, memory, sizeof(snapshot.memory));
+  for (size_t page = 0; page < 0x100; ++page)
+    if (sharedPages[page] != NULL)
+      memcpy(snapshot.memory + page * 0x100, sharedPages[page].get(), 0x100);
+  snapshot.bootRomMapped = bootRomMapped;
+}
+
+void Memory::load(const Snapshot& snapshot) {
+  for (std::shared_ptr<uint8_t[]>& shared : sharedPages) shared.reset();
+  memcpy(memory, snapshot.memory, sizeof(snapshot.memory));
+  bootRomMapped = snapshot.bootRomMapped;
+  mapPages();
+
+  // ROM pages can only have changed by switching banks, which mapPages
+  // already handled. Code copied into RAM may differ from what was cached.
+  for (size_t page = 0; page < 0x100; ++page)
+    if (codePages[page] && !readOnlyPages[page] && blockCache != NULL)
+      blockCache->invalidatePage((uint8_t)page);
+}
+
+// Only these pages are shared by fork; the rest are read directly by the PPU
+// and timer.
+static bool isShareable(size_t page) {
+  return page < 0x80 || (page >= 0xA0 && page < 0xFE);
+}
+
+void Memory::fork(Memory& child) {
+  for (size_t page = 0; page < 0x100; ++page) {
+    if (isShareable(page) && pages[page] == memory + page * 0x100)
+      share((uint8_t)page);
+
+    // Pages the cartridge is mapped over are never read from `memory`.
+    child.sharedPages[page] = sharedPages[page];
+    if (pages[page] == memory + page * 0x100)
+      memcpy(child.memory + page * 0x100, memory + page * 0x100, 0x100);
+  }
+
+  child.bootRom = bootRom;
+  child.bootRomMapped = bootRomMapped;
+  child.mapPages();
+}
+
+// Moves a page of `memory` into a copy that forks can share.
+void Memory::share(uint8_t page) {
+  sharedPages[page] = std::make_shared<uint8_t[]>(0x100);
+  memcpy(sharedPages[page].get(), memory + page * 0x100, 0x100);
+  mapRange(page, 1, sharedPages[page].get(), false);
+}
+
+// Copies a shared page back into `memory` before it's written to.
+uint8_t* Memory::unshare(uint8_t page) {
+  memcpy(memory + page * 0x100, sharedPages[page].get(), 0x100);
+  sharedPages[page].reset();
+  mapRange(page, 1, memory + page * 0x100, false);
+  return pages[page];
+}
+
+void Memory::setCodePage(uint8_t page, bool hasCode) {
+  codePages[page] = hasCode;
+  updatePage(page);
+}
+
+void Memory::updatePage(uint8_t page) {
+  readPages[page] = readWatchPages[page] ? NULL : pages[page];
+
+  // The I/O page stays on the slow path for writes: DIV resets on any write.
+  bool isVRAM = page >= 0x80 && page < 0xA0;
+  writePages[page] = !shouldWriteToMemory || page == 0xFF ||
+                             readOnlyPages[page] || codePages[page] ||
+                             isShared(page) || writeWatchPages[page] ||
+                             (isVRAM && tileCache != NULL) ||
+                             ((isVRAM || page == 0xFE) &&
+                              videoWriteCallback != NULL)
+                         ? NULL
+                         : pages[page];
+}
+
+void Memory::setTileCache(TileCache* cache) {
+  tileCache = cache;
+  for (size_t page = 0x80; page < 0xA0; ++page) updatePage((uint8_t)page);
+}
+
+void Memory::setVideoWriteCallback(VideoWriteCallback callback,
+                                   void* context) {
+  videoWriteCallback = callback;
+  videoWriteContext = context;
+  for (size_t page = 0x80; page < 0xA0; ++page) updatePage((uint8_t)page);
+  updatePage(0xFE);
+}
+
+void Memory::addWatch(GameboyEventType eventType, uint16_t start,
+                      uint16_t end, GameboyEventCallback callback,
+                      void* context) {
+  assert(start <= end);
+  watches.push_back({eventType, start, end, callback, context});
+
+  if (watched == NULL) watched = std::make_unique<std::bitset<0x10000>[]>(4);
+
+  for (uint32_t address = start; address <= end; ++address)
+    watched[eventType][address] = true;
+
+  if (eventType == GameboyEventType::MEM_READ_BYTE ||
+      eventType == GameboyEventType::MEM_READ_WORD)
+    ++readWatchCount;
+
+  if (eventType == GameboyEventType::MEM_READ_WORD ||
+      eventType == GameboyEventType::MEM_WRITE_WORD) {
+    ++wordWatchCount;
+    return;
+  }
+
+  bool* watchPages = eventType == GameboyEventType::MEM_READ_BYTE
+                         ? readWatchPages
+                         : writeWatchPages;
+  for (uint32_t page = start >> 8; page <= (uint32_t)(end >> 8); ++page) {
+    watchPages[page] = true;
+    updatePage((uint8_t)page);
+  }
+}
+
+void Memory::clearWatches() {
+  watches.clear();
+  watched.reset();
+  wordWatchCount = 0;
+  readWatchCount = 0;
+
+  for (size_t page = 0; page < 0x100; ++page) {
+    readWatchPages[page] = false;
+    writeWatchPages[page] = false;
+    updatePage((uint8_t)page);
+  }
+}
+
+void Memory::notify(GameboyEventType eventType, GameboyEventData data) {
+  uint16_t address = data.memory.address;
+
+  for (const GameboyWatch& watch : watches) {
+    if (watch.eventType == eventType && address >= watch.start &&
+        address <= watch.end)
+      watch.callback(data, watch.context);
+  }
+}
@@ -1,34 +1,63 @@
 #pragma once
 
-#include <SDL_events.h>
 #include <_types/_uint16_t.h>
 #include <_types/_uint8_t.h>
 #include <malloc/_malloc.h>
 
+#include <bitset>
 #include <cstdlib>
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 #include "../lib/tester.h"
+#include "blockcache.h"
+#include "cartridge.h"
 #include "events.h"
+#include "tilecache.h"
 #include "utils.h"
 
+// Called before a write to VRAM, OAM or the LCD registers, see
+// Memory::setVideoWriteCallback.
+typedef void (*VideoWriteCallback)(void* context);
+
 class Memory {
  public:
   Memory() {
-    if (shouldWriteToMemory && memory == NULL) memory = new uint8_t[0x10000];
+    // calloc leaves fresh pages to the OS to zero on first touch, so the
+    // parts a forked instance shares cost nothing.
+    if (shouldWriteToMemory && memory == NULL)
+      memory = (uint8_t*)calloc(0x10000, 1);
+    mapPages();
   }
   ~Memory() {
     if (memory != NULL && shouldWriteToMemory) free(memory);
   }
 
   // Read 8-bit byte from a given address
-  uint8_t readByte(uint16_t address);
+  uint8_t readByte(uint16_t address) {
+    uint8_t* page = readPages[address >> 8];
+    if (page != NULL) return page[address & 0xFF];
+    return readIO(address);
+  };
   // Read 16-bit word from a given address
-  uint16_t readWord(uint16_t address);
+  uint16_t readWord(uint16_t address) {
+    uint16_t value = (uint16_t)readByte(address + 1) << 8 | readByte(address);
+    if (wordWatchCount != 0 &&
+        isWatched(GameboyEventType::MEM_READ_WORD, address))
+      notify(GameboyEventType::MEM_READ_WORD,
+             {.memory = {address, 0, value, memory}});
+    return value;
+  };
 
   // Write 8-bit byte to a given address
-  void writeByte(uint16_t address, uint8_t value);
+  void writeByte(uint16_t address, uint8_t value) {
+    ++writeCount;
+    uint8_t* page = writePages[address >> 8];
+    if (page != NULL)
+      page[address & 0xFF] = value;
+    else
+      writeIO(address, value, true);
+  };
   void writeByte(uint16_t address, uint8_t value, bool triggerListener);
 
   // Write 16-bit word to a given address
@@ -36,19 +65,128 @@ class Memory {
 
   uint8_t* memory = NULL;
 
+  // Bytes written through writeByte, so idle loops can tell nothing changed.
+  uint64_t writeCount = 0;
+
   bool shouldWriteToMemory = true;
-  int num_mem_accesses;
+  int num_mem_accesses = 0;
   struct mem_access mem_accesses[16];
 
   size_t MEM_SIZE = 0x10000;
 
-  void addEventListener(GameboyEventType eventType,
-                        GameboyEventCallback callback) {
-    listeners[eventType].push_back(callback);
+  // Set by the CPU while it executes from cached blocks.
+  BlockCache* blockCache = NULL;
+
+  // Set by writes to IF or IE, which can make an interrupt due in the middle
+  // of a cached block. The CPU clears it when it stops to let it be taken.
+  bool interruptCheck = false;
+
+  // Rebuilds the page tables. Must be called after replacing `memory`,
+  // `MEM_SIZE` or `shouldWriteToMemory`.
+  void mapPages();
+
+  // Pages holding cached code route their writes through writeIO so the
+  // block cache sees them.
+  void setCodePage(uint8_t page, bool hasCode);
+
+  // While a tile cache is attached, writes to VRAM leave the fast path so it
+  // can mark tiles dirty.
+  void setTileCache(TileCache* cache);
+
+  // Calls back before every write to VRAM, OAM or FF40-FF4B, so the PPU can
+  // draw the pixels due before the write with the old values. Those writes
+  // all leave the fast path while a callback is set.
+  void setVideoWriteCallback(VideoWriteCallback callback, void* context);
+
+  // Maps the cartridge's ROM and RAM banks over 0000-7FFF and A000-BFFF.
+  // Memory doesn't take ownership. Without a cartridge the whole address
+  // space is backed by `memory`.
+  void insertCartridge(Cartridge* c);
+
+  // The boot ROM overlays 0000-00FF until the game writes to 0xFF50.
+  void mapBootRom(std::vector<uint8_t> rom);
+
+  // The address space as the CPU last left it, for save states. Loading
+  // rebuilds the page tables for the cartridge's current banks, so load the
+  // cartridge first.
+  struct Snapshot {
+    uint8_t memory[0x10000];
+    bool bootRomMapped;
   };
+  void save(Snapshot& snapshot);
+  void load(const Snapshot& snapshot);
+
+  // Gives `child`, which should have the same cartridge inserted, this
+  // memory's contents. RAM pages are shared copy-on-write: both map the same
+  // copy until one of them writes to it. VRAM, OAM and the I/O page, which
+  // the PPU and timer access through `memory` directly, are copied.
+  void fork(Memory& child);
+
+  // Read a byte without firing watches.
+  uint8_t peekByte(uint16_t address);
+
+  // Calls back on every access of the given type to [start, end]. Only the
+  // watched addresses leave the page table fast path.
+  void addWatch(GameboyEventType eventType, uint16_t start, uint16_t end,
+                GameboyEventCallback callback, void* context);
+  void clearWatches();
+
+  // Whether anybody is told about reads, which skipping idle loops would
+  // hide.
+  bool hasReadWatches() { return readWatchCount != 0; };
 
  private:
-  GameboyEventListenerMap listeners;
+  // Slow paths for pages without a direct pointer: I/O registers, watches,
+  // cached code and the tester's partial memory.
+  uint8_t readIO(uint16_t address);
+  void writeIO(uint16_t address, uint8_t value, bool triggerListener);
+  void updatePage(uint8_t page);
+  uint8_t* homePage(uint8_t page);
+  bool isShared(uint8_t page) {
+    return sharedPages[page] != NULL && pages[page] == sharedPages[page].get();
+  };
+  void share(uint8_t page);
+  uint8_t* unshare(uint8_t page);
+  void mapRange(uint8_t firstPage, size_t count, uint8_t* base, bool readOnly);
+  void mapCartridge();
+  void unmapBootRom();
+  void copyToOAM(uint8_t source);
+
+  bool isWatched(GameboyEventType eventType, uint16_t address) {
+    return watched != NULL && watched[eventType][address];
+  };
+  void notify(GameboyEventType eventType, GameboyEventData data);
+
+  // One entry per 256-byte page. `pages` is the backing storage (NULL if the
+  // page isn't fully inside MEM_SIZE, or is disabled cartridge RAM); the read
+  // and write tables hold the same pointer, or NULL when accesses to that
+  // page need the slow path.
+  uint8_t* pages[0x100] = {};
+  uint8_t* readPages[0x100];
+  uint8_t* writePages[0x100];
+  bool readOnlyPages[0x100] = {};
+  bool codePages[0x100] = {};
+
+  // Pages shared with forked instances, mapped instead of the page's own
+  // part of `memory`. Writes take the slow path, which copies the page back
+  // into `memory` first.
+  std::shared_ptr<uint8_t[]> sharedPages[0x100];
+
+  Cartridge* cartridge = NULL;
+  TileCache* tileCache = NULL;
+  VideoWriteCallback videoWriteCallback = NULL;
+  void* videoWriteContext = NULL;
+  std::vector<uint8_t> bootRom;
+  bool bootRomMapped = false;
+
+  // One bit per address for each event type, so the slow path only scans
+  // `watches` for addresses somebody asked about.
+  std::unique_ptr<std::bitset<0x10000>[]> watched;  // Allocated on demand.
+  bool readWatchPages[0x100] = {};
+  bool writeWatchPages[0x100] = {};
+  size_t wordWatchCount = 0;
+  size_t readWatchCount = 0;
+  std::vector<GameboyWatch> watches;
 };
 
 class VRAM {
@@ -64,7 +202,8 @@ class VRAM {
   uint8_t getWX() { return memory->readByte(WX_ADDR); };
   uint8_t getWY() { return memory->readByte(WY_ADDR); };
 
-  int getSpriteSize() { return 0; };
+  // Sprite height in pixels, selected by LCDC bit 2.
+  int getSpriteSize() { return (getLCDC() & 0x04) != 0 ? 16 : 8; };
 
  private:
   Memory* memory;
@@ -75,6 +214,6 @@ class VRAM {
   static const uint16_t SCX_ADDR = 0xFF43;
   static const uint16_t LYC_ADDR = 0xFF45;
   static const uint16_t LY_ADDR = 0xFF44;
-  static const uint16_t WX_ADDR = 0xFF4A;
-  static const uint16_t WY_ADDR = 0xFF4B;
+  static const uint16_t WX_ADDR = 0xFF4B;
+  static const uint16_t WY_ADDR = 0xFF4A;
 };
@@ -6,23 +6,11 @@
 #include <sys/_types/_int16_t.h>
 #include <sys/_types/_int8_t.h>
 
-#include <bitset>
+#include <algorithm>
+#include <cstring>
 
 #include "mem.h"
-
-void PixelFetcher::readTileLine(uint8_t bitPlane, uint16_t tileDataAddr,
-                                uint8_t tileId, bool signedId, uint8_t tileLine,
-                                uint flags, uint8_t *data[8]) {
-  uint16_t offset =
-      signedId ? uint16_t(int16_t(tileDataAddr) + int16_t(int8_t(tileId)) * 16)
-               : tileDataAddr + (uint16_t(tileId) * 16);
-
-  if ((flags & spriteFlipY) != 0) {
-    auto height =
-        uint8(8 << ((vram.getLCDC() & vram.getSpriteSize()) >> 2) - 1);
-    auto tileLine = height - tileLine;
-  }
-}
+#include "tiledecode.h"
 
 void PixelFetcher::tick() {
   ++ticks;
@@ -31,57 +19,48 @@ void PixelFetcher::tick() {
 
   ticks = 0;
 
-  /*
-    TILE_SEL	VRAM Range
-    0	$8800 - $97FF
-    1	$8000 - $8FFF (OBJ area)
-  */
-  std::bitset<8> LCDC = std::bitset<8>(memory->readByte(0xFF40));
-  int TILE_SEL = LCDC.test(4);
-  uint16_t vramRange = TILE_SEL == 0 ? 0x8800 : 0x8000;
-
-  uint8_t LY = memory->memory[0xFF44];
-  uint8_t LX = tileIndex;
-  uint8_t SCY = memory->memory[0xFF42];
-  uint8_t SCX = memory->memory[0xFF43];
+  uint8_t LCDC = memory->readByte(0xFF40);
 
   switch (state) {
     case State::READ_TILE_ID: {
-      tileId = memory->readByte(mapAddr + uint16_t(tileIndex));
+      // Tile maps are 32 tiles wide and wrap around horizontally.
+      uint16_t mapAddr;
+      uint8_t column;
+      if (window) {
+        mapAddr = PPU::windowMapAddress(LCDC) + (windowLine / 8) * 32;
+        column = tileIndex & 31;
+        tileLine = windowLine % 8;
+      } else {
+        uint8_t y = memory->memory[0xFF42] + memory->memory[0xFF44];
+        mapAddr = PPU::backgroundMapAddress(LCDC) + (y / 8) * 32;
+        column = (memory->memory[0xFF43] / 8 + tileIndex) & 31;
+        tileLine = y % 8;
+      }
+
+      tileId = memory->readByte(mapAddr + column);
       state = State::READ_TILE_DATA_0;
       break;
     }
 
     case State::READ_TILE_DATA_0: {
-      int offset = vramRange + (uint16_t(tileId) * 16);
-      int addr = offset + (uint16_t(tileLine) * 2);
-      int data = memory->readByte(addr);
-      for (unsigned int i = 0; i <= 7; ++i) {
-        pixelData[i] = (data >> i) & 1;
-      }
+      uint16_t addr = PPU::tileDataAddress(LCDC, tileId, tileLine);
+      tileDataLow = memory->readByte(addr);
 
       state = State::READ_TILE_DATA_1;
       break;
     }
 
     case State::READ_TILE_DATA_1: {
-      int offset = 0x8000 + (uint16_t(tileId) * 16);
-      uint16_t addr = offset + (uint16_t(tileLine) * 2);
-      uint8_t data = memory->readByte(addr + 1);
-      for (unsigned int i = 0; i <= 7; ++i) {
-        pixelData[i] |= ((data >> i) & 1) << 1;
-      }
+      uint16_t addr = PPU::tileDataAddress(LCDC, tileId, tileLine);
+      decodeTileRow(tileDataLow, memory->readByte(addr + 1), pixelData);
 
       state = State::PUSH_TO_FIFO;
       break;
     }
 
     case State::PUSH_TO_FIFO: {
-      if (fifo.length() <= 8) {
-        for (int i = 7; i >= 0; --i) {
-          fifo.push(pixelData[i]);
-        }
-
+      if (fifo.length() <= PixelFIFO::CAPACITY - 8) {
+        fifo.pushRow(pixelData);
         ++tileIndex;
         state = State::READ_TILE_ID;
       }
@@ -90,99 +69,381 @@ void PixelFetcher::tick() {
   }
 }
 
-void PixelFetcher::start(uint16_t mapAddr, uint8_t tileLine) {
+void PixelFetcher::startBackground() { start(false, 0); }
+
+void PixelFetcher::startWindow(uint8_t windowLine) { start(true, windowLine); }
+
+void PixelFetcher::start(bool window, uint8_t windowLine) {
   tileIndex = 0;
-  this->mapAddr = mapAddr;
-  this->tileLine = tileLine;
+  this->window = window;
+  this->windowLine = windowLine;
   state = State::READ_TILE_ID;
   fifo.clear();
 }
 
-void PPU::tick() {
-  ++ticks;
+void PixelFetcher::save(Snapshot& snapshot) {
+  snapshot.state = state;
+  snapshot.ticks = ticks;
+  snapshot.window = window;
+  snapshot.windowLine = windowLine;
+  snapshot.tileIndex = tileIndex;
+  snapshot.tileId = tileId;
+  snapshot.tileLine = tileLine;
+  snapshot.tileDataLow = tileDataLow;
+  memcpy(snapshot.pixelData, pixelData, sizeof(pixelData));
+  snapshot.fifo = fifo;
+}
 
-  if (memory->readByte(0xFF44) == memory->readByte(0xFF45)) {
-    memory->writeByte(0xFF0F, memory->readByte(0xFF0F) | 0x2);
-  }
+void PixelFetcher::load(const Snapshot& snapshot) {
+  state = snapshot.state;
+  ticks = snapshot.ticks;
+  window = snapshot.window;
+  windowLine = snapshot.windowLine;
+  tileIndex = snapshot.tileIndex;
+  tileId = snapshot.tileId;
+  tileLine = snapshot.tileLine;
+  tileDataLow = snapshot.tileDataLow;
+  memcpy(pixelData, snapshot.pixelData, sizeof(pixelData));
+  fifo = snapshot.fifo;
+}
 
+void PPU::save(Snapshot& snapshot) {
+  snapshot.state = state;
+  snapshot.x = x;
+  snapshot.transfer = transfer;
+  pixelFetcher.save(snapshot.fetcher);
+  snapshot.spriteFifo = spriteFifo;
+  memcpy(snapshot.lineSprites, lineSprites, sizeof(lineSprites));
+  snapshot.lineSpriteCount = lineSpriteCount;
+  snapshot.windowTriggered = windowTriggered;
+  snapshot.windowLine = windowLine;
+  display.save(snapshot.display);
+}
+
+void PPU::load(const Snapshot& snapshot) {
+  state = snapshot.state;
+  x = snapshot.x;
+  transfer = snapshot.transfer;
+  pixelFetcher.load(snapshot.fetcher);
+  spriteFifo = snapshot.spriteFifo;
+  memcpy(lineSprites, snapshot.lineSprites, sizeof(lineSprites));
+  lineSpriteCount = snapshot.lineSpriteCount;
+  windowTriggered = snapshot.windowTriggered;
+  windowLine = snapshot.windowLine;
+  display.load(snapshot.display);
+}
+
+int PPU::step(uint64_t now) {
   switch (state) {
     case State::OAM_SCAN: {
-      // In this state, the PPU would scan the OAM (Objects Attribute Memory)
-      // from 0xfe00 to 0xfe9f to mix sprite pixels in the current line later.
-      // This always takes 40 ticks.
+      // The PPU has scanned the OAM (Objects Attribute Memory) from 0xfe00 to
+      // 0xfe9f. The scanline renderer draws the whole line now, which tells
+      // it how long the transfer takes; the FIFO renderer draws as it goes.
+      scanOAM();
+      if (memory->memory[0xFF44] == memory->memory[0xFF4A])
+        windowTriggered = true;
+
+      setMode(State::PIXEL_TRANSFER);
+      startTransfer(now);
+      if (renderer == Renderer::SCANLINE) {
+        transfer.dots = drawScanline();
+        x = 160;
+        return transfer.dots;
+      }
 
-      if (ticks == 40) {
-        x = 0;
-        int y = memory->readByte(0xFF42) + memory->readByte(0xFF44);
+      // Every pixel takes at least a dot.
+      return 160 + transfer.discard;
+    }
+
+    case State::PIXEL_TRANSFER: {
+      int elapsed = (int)(now - transfer.start);
+      if (x < 160) drawPixels(elapsed);
 
-        uint8_t tileLine = y % 8;
-        uint16_t tileMapRowAddr = 0x9800 + (uint16_t((y % 256) / 8) * 32);
+      // Not done yet; check again once the remaining pixels could be.
+      if (x < 160) return 160 - x + transfer.discard;
+      // Fetching the last sprites ran past the end of the previous estimate.
+      if (transfer.dots > elapsed) return transfer.dots - elapsed;
 
-        pixelFetcher.start(tileMapRowAddr, tileLine);
+      setMode(State::H_BLANK);
+      return DOTS_PER_LINE - OAM_SCAN_DOTS - transfer.dots;
+    }
 
-        state = State::PIXEL_TRANSFER;
+    case State::H_BLANK: {
+      // A full scanline takes 456 dots to complete. At the end of a scanline,
+      // the PPU goes back to the initial OAM Search state. When we reach line
+      // 144, we switch to VBlank state instead.
+      incrementLY();
+
+      if (memory->memory[0xFF44] == 144) {
+        display.vBlank();
+        memory->writeByte(0xFF0F, memory->readByte(0xFF0F) | 0x1);
+        setMode(State::V_BLANK);
+        return DOTS_PER_LINE;
       }
-      break;
+
+      setMode(State::OAM_SCAN);
+      return OAM_SCAN_DOTS;
     }
 
-    case State::PIXEL_TRANSFER: {
-      // Fetch pixel data into our pixel FIFO.
-      pixelFetcher.tick();
+    case State::V_BLANK: {
+      // Ten scanlines (144-153) of VBlank before starting over.
+      incrementLY();
+
+      if (memory->memory[0xFF44] == 0) {
+        windowTriggered = false;
+        windowLine = 0;
+        setMode(State::OAM_SCAN);
+        return OAM_SCAN_DOTS;
+      }
 
-      if (!pixelFetcher.fifo.isEmpty()) {
-        uint8_t pixelColor = pixelFetcher.fifo.pop();
+      return DOTS_PER_LINE;
+    }
+  }
 
-        auto paletteColor =
-            (memory->readByte(0xFF47) >> ((uint8_t)pixelColor * 2)) & 3;
+  return DOTS_PER_LINE;
+}
 
-        display.write(paletteColor);
-        ++x;
-      }
+// Sets up the current line's PIXEL_TRANSFER, which began at `now`.
+void PPU::startTransfer(uint64_t now) {
+  x = 0;
+  transfer.start = now;
+  transfer.dots = 0;
+  transfer.inWindow = false;
+  transfer.nextSprite = 0;
+
+  // The fetcher always starts on a tile boundary; the first SCX % 8 pixels
+  // are shifted out without being drawn.
+  transfer.discard = memory->memory[0xFF43] % 8;
 
-      if (x == 160) {
-        display.hBlank();
-        state = State::H_BLANK;
+  pixelFetcher.startBackground();
+  spriteFifo.clear();
+}
+
+// Pushes pixels through the fetcher and FIFO until `untilDots` dots into the
+// transfer or the end of the line. Nothing the line reads can change during
+// one call, so the registers are only read once.
+void PPU::drawPixels(int untilDots) {
+  uint8_t LCDC = memory->memory[0xFF40];
+  int windowX = isWindowVisible(LCDC) ? memory->memory[0xFF4B] - 7 : 160;
+  bool spritesEnabled = (LCDC & 0x02) != 0;
+
+  while (x < 160 && transfer.dots < untilDots) {
+    // Once the window starts, throw away the background pixels and fetch
+    // from the window map instead. When WX < 7 the window's first pixels
+    // are left of the screen.
+    if (!transfer.inWindow && x >= windowX) {
+      transfer.inWindow = true;
+      pixelFetcher.startWindow(windowLine);
+      transfer.discard = x - windowX;
+    }
+
+    // Fetch pixel data into our pixel FIFO.
+    pixelFetcher.tick();
+
+    // Merge the rows of sprites starting at this pixel into the sprite FIFO.
+    // Pixels already queued by earlier sprites keep priority unless they're
+    // transparent. Sprites hanging off the left edge start at x = 0 with
+    // their hidden pixels dropped.
+    while (spritesEnabled && transfer.nextSprite < lineSpriteCount &&
+           lineSprites[transfer.nextSprite].x <= x + 8) {
+      const Sprite& sprite = lineSprites[transfer.nextSprite++];
+      if (sprite.x == 0) continue;
+
+      uint8_t row[8];
+      fetchSpriteRow(sprite, row);
+      int hidden = x + 8 - sprite.x;
+
+      for (int i = hidden; i < 8; ++i) {
+        size_t slot = i - hidden;
+        if (slot >= spriteFifo.length())
+          spriteFifo.push(row[i]);
+        else if ((spriteFifo.at(slot) & 0x3) == 0)
+          spriteFifo.at(slot) = row[i];
       }
-      break;
+
+      transfer.dots += SPRITE_FETCH_DOTS;
     }
 
-    case State::H_BLANK: {
-      // A full scanline takes 456 ticks to complete. At the end of a
-      // scanline, the PPU goes back to the initial OAM Search state.
-      // When we reach line 144, we switch to VBlank state instead.
-      // printf("%3d H_BLANK\n", ticks);
-
-      if (ticks == 456) {
-        ticks = 0;
-        ++memory->memory[0xFF44];
-        if (memory->memory[0xFF44] == 144) {
-          display.vBlank();
-
-          memory->writeByte(0xFF0F, memory->readByte(0xFF0F) | 0x1);
-
-          state = State::V_BLANK;
-        } else {
-          state = State::OAM_SCAN;
-        }
+    if (!pixelFetcher.fifo.isEmpty()) {
+      uint8_t pixelColor = pixelFetcher.fifo.pop();
+      if ((LCDC & 0x01) == 0) pixelColor = 0;
+
+      if (transfer.discard > 0) {
+        --transfer.discard;
+      } else {
+        uint8_t spritePixel = spriteFifo.isEmpty() ? 0 : spriteFifo.pop();
+        display.write(mixPixel(pixelColor, spritePixel));
+        ++x;
       }
+    }
 
-      break;
+    ++transfer.dots;
+  }
+
+  if (x == 160 && transfer.inWindow) ++windowLine;
+}
+
+// Draws the current line in one pass, reading the tile map straight from VRAM
+// and pre-decoded tile rows from the tile cache. Returns the length of the
+// transfer in dots.
+int PPU::drawScanline() {
+  const uint8_t *bytes = memory->memory;
+  uint8_t LCDC = bytes[0xFF40];
+  uint8_t SCX = bytes[0xFF43];
+  uint8_t y = bytes[0xFF42] + bytes[0xFF44];
+
+  uint8_t colors[160];
+  uint8_t spritePixels[160] = {};
+  int dots = MIN_TRANSFER_DOTS + SCX % 8;
+
+  if ((LCDC & 0x01) == 0) {
+    memset(colors, 0, sizeof(colors));
+    dots = MIN_TRANSFER_DOTS;
+  } else {
+    const uint8_t *mapRow = bytes + backgroundMapAddress(LCDC) + (y / 8) * 32;
+    uint8_t tileLine = y % 8;
+
+    int x = 0;
+    while (x < 160) {
+      uint8_t mapX = SCX + x;
+      const uint8_t *pixels =
+          tileCache.row(tileIndex(LCDC, mapRow[mapX / 8]), tileLine);
+
+      // The first tile may be cut short by the fine scroll.
+      for (int i = mapX % 8; i < 8 && x < 160; ++i, ++x) colors[x] = pixels[i];
     }
 
-    case State::V_BLANK: {
-      // printf("%3d V_BLANK %d\n", ticks, memory->readByte(0xFF44));
-      // Wait ten more scanlines before starting over.
-      // getchar();
-      if (ticks == 456) {
-        ticks = 0;
-        ++memory->memory[0xFF44];
-        if (memory->memory[0xFF44] == 153) {
-          memory->writeByte(0xFF44, 0);
-          state = State::OAM_SCAN;
-        }
+    if (isWindowVisible(LCDC)) {
+      int windowX = bytes[0xFF4B] - 7;
+      const uint8_t *windowRow =
+          bytes + windowMapAddress(LCDC) + (windowLine / 8) * 32;
+
+      for (int x = std::max(windowX, 0); x < 160; ++x) {
+        int column = x - windowX;
+        const uint8_t *pixels = tileCache.row(
+            tileIndex(LCDC, windowRow[column / 8]), windowLine % 8);
+        colors[x] = pixels[column % 8];
       }
 
-      break;
+      ++windowLine;
+      dots += WINDOW_FETCH_DOTS;
+    }
+  }
+
+  // Draw sprites in priority order, each only over pixels no earlier sprite
+  // covered with an opaque pixel.
+  bool spritesEnabled = (LCDC & 0x02) != 0;
+  for (int s = 0; spritesEnabled && s < lineSpriteCount; ++s) {
+    const Sprite &sprite = lineSprites[s];
+    if (sprite.x == 0 || sprite.x >= 168) continue;
+
+    uint8_t row[8];
+    fetchSpriteRow(sprite, row);
+
+    for (int i = 0; i < 8; ++i) {
+      int x = sprite.x - 8 + i;
+      if (x >= 0 && x < 160 && (spritePixels[x] & 0x3) == 0)
+        spritePixels[x] = row[i];
     }
+
+    dots += SPRITE_FETCH_DOTS;
+  }
+
+  for (int x = 0; x < 160; ++x)
+    display.write(mixPixel(colors[x], spritePixels[x]));
+
+  return dots;
+}
+
+// The window covers the rest of the line from WX - 7 once LY has reached WY
+// this frame. On DMG clearing LCDC bit 0 hides it along with the background.
+bool PPU::isWindowVisible(uint8_t LCDC) {
+  return (LCDC & 0x21) == 0x21 && windowTriggered &&
+         memory->memory[0xFF4B] <= 166;
+}
+
+// Selects the (at most 10) sprites overlapping the current line, in OAM
+// order, and sorts them by X.
+void PPU::scanOAM() {
+  const uint8_t *oam = memory->memory + 0xFE00;
+  int LY = memory->memory[0xFF44];
+  int height = vram.getSpriteSize();
+
+  lineSpriteCount = 0;
+  for (int i = 0; i < 40 && lineSpriteCount < MAX_SPRITES_PER_LINE; ++i) {
+    const uint8_t *entry = oam + i * 4;
+    int top = entry[0] - 16;
+    if (LY < top || LY >= top + height) continue;
+
+    Sprite sprite = {entry[0], entry[1], entry[2], entry[3]};
+
+    // Insertion sort; the list is never longer than 10.
+    int j = lineSpriteCount++;
+    for (; j > 0 && lineSprites[j - 1].x > sprite.x; --j)
+      lineSprites[j] = lineSprites[j - 1];
+    lineSprites[j] = sprite;
   }
 }
+
+// The sprite's pixels on the current line, leftmost first, in the sprite FIFO
+// format.
+void PPU::fetchSpriteRow(const Sprite &sprite, uint8_t row[8]) {
+  int height = vram.getSpriteSize();
+  int line = memory->memory[0xFF44] - (sprite.y - 16);
+  if ((sprite.flags & 0x40) != 0) line = height - 1 - line;
+
+  // 8x16 sprites ignore bit 0 of the tile number.
+  uint8_t tile =
+      height == 16 ? (sprite.tile & 0xFE) | (line >> 3) : sprite.tile;
+  const uint8_t *pixels = tileCache.row(tile, line & 7);
+
+  bool flipX = (sprite.flags & 0x20) != 0;
+  uint8_t attributes = sprite.flags & 0x90;
+  for (int i = 0; i < 8; ++i) row[i] = pixels[flipX ? 7 - i : i] | attributes;
+}
+
+// Resolves a background color index and a sprite FIFO pixel to a shade.
+// Sprites lose to background colors 1-3 when their priority bit is set.
+uint8_t PPU::mixPixel(uint8_t bgColor, uint8_t spritePixel) {
+  uint8_t spriteColor = spritePixel & 0x3;
+
+  if (spriteColor == 0 || ((spritePixel & 0x80) != 0 && bgColor != 0))
+    return (memory->memory[0xFF47] >> (bgColor * 2)) & 3;
+
+  uint8_t palette = memory->memory[(spritePixel & 0x10) != 0 ? 0xFF49 : 0xFF48];
+  return (palette >> (spriteColor * 2)) & 3;
+}
+
+// Mirrors the mode into STAT bits 0-1 and raises the STAT interrupt for modes
+// that have their source enabled (bit 3 HBlank, bit 4 VBlank, bit 5 OAM).
+void PPU::setMode(State newState) {
+  state = newState;
+
+  static const uint8_t MODE_BITS[] = {2, 3, 0, 1};
+  uint8_t mode = MODE_BITS[(int)newState];
+  memory->memory[0xFF41] = (memory->memory[0xFF41] & ~0x3) | mode;
+
+  if (newState == State::H_BLANK) requestStatInterrupt(3);
+  if (newState == State::V_BLANK) requestStatInterrupt(4);
+  if (newState == State::OAM_SCAN) requestStatInterrupt(5);
+}
+
+// Advances LY, wrapping after line 153, and updates the LY=LYC coincidence
+// flag (STAT bit 2), raising the STAT interrupt when its source (bit 6) is
+// enabled.
+void PPU::incrementLY() {
+  uint8_t &LY = memory->memory[0xFF44];
+  LY = LY == 153 ? 0 : LY + 1;
+
+  if (LY == memory->memory[0xFF45]) {
+    memory->memory[0xFF41] |= 0x4;
+    requestStatInterrupt(6);
+  } else {
+    memory->memory[0xFF41] &= ~0x4;
+  }
+}
+
+void PPU::requestStatInterrupt(uint8_t enableBit) {
+  if ((memory->memory[0xFF41] & (1 << enableBit)) != 0)
+    memory->writeByte(0xFF0F, memory->readByte(0xFF0F) | 0x2);
+}
@@ -4,28 +4,54 @@
 #include <_types/_uint8_t.h>
 
 #include <cstddef>
-#include <deque>
+#include <type_traits>
 #include <vector>
 
 #include "display.h"
 #include "mem.h"
+#include "tilecache.h"
 
+// Fixed-capacity ring buffer. The hardware FIFOs never hold more than 16
+// pixels, so indices wrap with a mask and nothing is allocated. The FIFO
+// renderer keeps its FIFOs filled between catchUp calls, so they're plain
+// data that save states copy as they are.
 class PixelFIFO {
  public:
-  void push(uint8_t value) { values.push_back(value); }
+  void push(uint8_t value) { values[(head + count++) & MASK] = value; }
+  // Pushes a whole tile row, leftmost pixel first.
+  void pushRow(const uint8_t row[8]) {
+    for (size_t i = 0; i < 8; ++i) values[(head + count + i) & MASK] = row[i];
+    count += 8;
+  }
   uint8_t pop() {
-    uint8_t returnValue = values[0];
-    values.pop_front();
+    uint8_t returnValue = values[head];
+    head = (head + 1) & MASK;
+    --count;
     return returnValue;
   }
-  size_t length() { return values.size() / sizeof(uint8_t); }
-  bool isEmpty() { return length() == 0; }
-  void clear() { values.clear(); };
+  // The i-th queued pixel, counting from the next one to pop.
+  uint8_t& at(size_t i) { return values[(head + i) & MASK]; }
+  size_t length() { return count; }
+  bool isEmpty() { return count == 0; }
+  void clear() {
+    head = 0;
+    count = 0;
+  };
+
+  static const size_t CAPACITY = 16;
 
  private:
-  std::deque<uint8_t> values;
+  static const size_t MASK = CAPACITY - 1;
+
+  // Zeroed so that snapshots never contain uninitialized bytes.
+  uint8_t values[CAPACITY] = {};
+  size_t head = 0;
+  size_t count = 0;
 };
 
+static_assert(std::is_trivially_copyable_v<PixelFIFO>,
+              "FIFOs are part of PPU::Snapshot");
+
 class PixelFetcher {
  public:
   PixelFetcher(Memory* m) : memory(m), vram(m){};
@@ -39,47 +65,188 @@ class PixelFetcher {
 
   PixelFIFO fifo;
 
-  void start(uint16_t tileMapRowAddr, uint8_t tileLine);
+  // Starts fetching the background for the current line. SCX and SCY are
+  // read again for every tile, so scrolling mid-line moves the rest of it.
+  void startBackground();
+  // Starts fetching the window from the given row of its tile map.
+  void startWindow(uint8_t windowLine);
   void tick();
-  void readTileLine(uint8_t bitPlane, uint16_t tileDataAddr, uint8_t tileId,
-                    bool signedId, uint8_t tileLine, uint flags,
-                    uint8_t* data[8]);
+
+  // Everything the fetcher carries between dots, for save states. The
+  // current two-dot fetch step carries over from one line to the next.
+  struct Snapshot {
+    State state;
+    int ticks;
+    bool window;
+    uint8_t windowLine;
+    int tileIndex;
+    int tileId;
+    uint8_t tileLine;
+    uint8_t tileDataLow;
+    uint8_t pixelData[8];
+    PixelFIFO fifo;
+  };
+  void save(Snapshot& snapshot);
+  void load(const Snapshot& snapshot);
 
  private:
-  State state;
-  int ticks;
+  void start(bool window, uint8_t windowLine);
+
+  State state = State::READ_TILE_ID;
+  int ticks = 0;
   Memory* memory;
-  uint16_t mapAddr;
-  uint8_t tileLine;
-  int tileIndex;
-  int tileId;
-  uint8_t pixelData[8];
-  uint8_t LX;
+  bool window = false;
+  uint8_t windowLine = 0;
+  int tileIndex = 0;  // Tiles fetched so far on this line.
+  int tileId = 0;
+  uint8_t tileLine = 0;
+  uint8_t tileDataLow = 0;
+  uint8_t pixelData[8] = {};  // Leftmost pixel first.
   VRAM vram;
 };
 
 class PPU {
  public:
   PPU(Memory* m)
-      : memory(m),
-        pixelFetcher(m),
-        vram(m){
-
-        };
+      : vram(m),
+        tileCache(m),
+        memory(m),
+        pixelFetcher(m){};
 
   enum class State { OAM_SCAN, PIXEL_TRANSFER, H_BLANK, V_BLANK };
 
-  uint8_t x;
-  int ticks;
-
-  State state;
+  // FIFO pushes every pixel through the PixelFetcher and PixelFIFO like the
+  // hardware does, one dot at a time, so writes to the LCD registers, VRAM or
+  // OAM during PIXEL_TRANSFER change the rest of the line (see catchUp).
+  // SCANLINE draws the whole line in one pass straight from VRAM when the
+  // mode begins, which is much cheaper but can't change its output mid-line.
+  enum class Renderer { FIFO, SCANLINE };
+
+  void setRenderer(Renderer newRenderer) { renderer = newRenderer; };
+  Renderer getRenderer() { return renderer; };
+
+  uint8_t x = 0;
+
+  State state = State::OAM_SCAN;
+
+  // Finishes the current mode, enters the next one and returns the dots until
+  // it should be called again. Called by the GameBoy scheduler whenever a
+  // mode ends, with the T-cycle timestamp it was due at. The FIFO renderer
+  // may need several calls to finish PIXEL_TRANSFER, since how long the mode
+  // lasts is only known once the line is drawn.
+  int step(uint64_t now);
+
+  // Draws the current line up to `now` with the FIFO renderer. Must be called
+  // before anything the line reads (LCD registers, VRAM or OAM) is written
+  // during PIXEL_TRANSFER, so that the pixels already out use the old values.
+  void catchUp(uint64_t now) {
+    if (state == State::PIXEL_TRANSFER && x < 160)
+      drawPixels((int)(now - transfer.start));
+  };
 
-  void tick();
   Display display;
 
   VRAM vram;
+  TileCache tileCache;
+
+  static const int DOTS_PER_LINE = 456;
+  static const int OAM_SCAN_DOTS = 80;
+  static const int MIN_TRANSFER_DOTS = 172;
+  static const int MAX_SPRITES_PER_LINE = 10;
+
+  // Address of row `line` of a tile, in the tile data area selected by LCDC
+  // bit 4 (0x8000 with unsigned IDs, or 0x9000 with signed IDs).
+  static uint16_t tileDataAddress(uint8_t LCDC, uint8_t tileId, uint8_t line) {
+    uint16_t base = (LCDC & 0x10) != 0 ? 0x8000 + tileId * 16
+                                       : 0x9000 + (int8_t)tileId * 16;
+    return base + line * 2;
+  };
+
+  // TileCache number of a tile ID in the area selected by LCDC bit 4.
+  static uint16_t tileIndex(uint8_t LCDC, uint8_t tileId) {
+    return (LCDC & 0x10) != 0 ? tileId : 256 + (int8_t)tileId;
+  };
+
+  // Background tile map selected by LCDC bit 3.
+  static uint16_t backgroundMapAddress(uint8_t LCDC) {
+    return (LCDC & 0x08) != 0 ? 0x9C00 : 0x9800;
+  };
+
+  // Window tile map selected by LCDC bit 6.
+  static uint16_t windowMapAddress(uint8_t LCDC) {
+    return (LCDC & 0x40) != 0 ? 0x9C00 : 0x9800;
+  };
+
+  // An OAM entry that overlaps the current line.
+  struct Sprite {
+    uint8_t y;      // Screen Y + 16.
+    uint8_t x;      // Screen X + 8.
+    uint8_t tile;   // Always from 0x8000.
+    uint8_t flags;  // Bit 7 behind BG, 6 Y flip, 5 X flip, 4 OBP1.
+  };
+
+  // Progress through the current line's PIXEL_TRANSFER. The FIFO renderer
+  // draws lazily: up to the current dot in catchUp, and the rest when step
+  // is called to end the mode.
+  struct Transfer {
+    uint64_t start;  // When the mode began, in T-cycles.
+    int dots;        // Dots drawn so far, or the whole line's for SCANLINE.
+    int discard;     // Pixels still to shift out without drawing them.
+    bool inWindow;
+    int nextSprite;  // Next entry of lineSprites to merge.
+  };
+
+  // Everything that carries over between calls to step and catchUp, for save
+  // states, including a line the FIFO renderer is partway through.
+  struct Snapshot {
+    State state;
+    uint8_t x;
+    Transfer transfer;
+    PixelFetcher::Snapshot fetcher;
+    PixelFIFO spriteFifo;
+    Sprite lineSprites[MAX_SPRITES_PER_LINE];
+    int lineSpriteCount;
+    bool windowTriggered;
+    uint8_t windowLine;
+    Display::Snapshot display;
+  };
+  void save(Snapshot& snapshot);
+  void load(const Snapshot& snapshot);
+
+  static const int SPRITE_FETCH_DOTS = 6;
+  static const int WINDOW_FETCH_DOTS = 6;
 
  private:
   Memory* memory;
   PixelFetcher pixelFetcher;
+
+  // Sprite pixels hold the color index in bits 0-1 and the sprite's priority
+  // and palette flags in bits 7 and 4. Index 0 is transparent.
+  PixelFIFO spriteFifo;
+
+  // Filled once per line by scanOAM, sorted by X so that earlier entries win
+  // where sprites overlap (ties go to the lower OAM index).
+  Sprite lineSprites[MAX_SPRITES_PER_LINE];
+  int lineSpriteCount = 0;
+
+  // Set once LY has matched WY this frame. windowLine counts the lines the
+  // window has actually been drawn on, which is the row of the window map
+  // it continues from.
+  bool windowTriggered = false;
+  uint8_t windowLine = 0;
+
+  bool isWindowVisible(uint8_t LCDC);
+  void scanOAM();
+  void fetchSpriteRow(const Sprite& sprite, uint8_t row[8]);
+  uint8_t mixPixel(uint8_t bgColor, uint8_t spritePixel);
+
+  Transfer transfer = {};
+  Renderer renderer = Renderer::FIFO;
+
+  void startTransfer(uint64_t now);
+  void drawPixels(int untilDots);
+  int drawScanline();
+  void setMode(State newState);
+  void incrementLY();
+  void requestStatInterrupt(uint8_t enableBit);
 };
@@ -7,10 +7,10 @@
 
 class FlagsRegister {
  public:
-  bool zero;
-  bool subtraction;
-  bool halfCarry;
-  bool carry;
+  bool zero = false;
+  bool subtraction = false;
+  bool halfCarry = false;
+  bool carry = false;
 
   uint8_t getValue() {
     uint8_t v = 0;
@@ -28,16 +28,16 @@ class FlagsRegister {
 
 class Registers {
  public:
-  uint8_t A;
-  uint8_t B;
-  uint8_t C;
-  uint8_t D;
-  uint8_t E;
+  uint8_t A = 0;
+  uint8_t B = 0;
+  uint8_t C = 0;
+  uint8_t D = 0;
+  uint8_t E = 0;
 
   FlagsRegister F;
 
-  uint8_t H;
-  uint8_t L;
+  uint8_t H = 0;
+  uint8_t L = 0;
 
   uint16_t get_AF();
   uint16_t get_BC();
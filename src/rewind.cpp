@@ -0,0 +1,176 @@
+#include "rewind.h"
+
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Unchanged bytes shorter than this stay inside a run of changed ones; a
+// shorter gap costs more in run headers than it saves.
+static const size_t MIN_GAP = 4;
+
+static size_t writeVarint(uint8_t *out, size_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+static size_t readVarint(const uint8_t *in, size_t &value) {
+  size_t length = 0;
+  int shift = 0;
+  value = 0;
+  do {
+    value |= (size_t)(in[length] & 0x7F) << shift;
+    shift += 7;
+  } while ((in[length++] & 0x80) != 0);
+  return length;
+}
+
+// Encodes `data` as the XOR against `base`: alternating varint counts of
+// unchanged and changed bytes, each count of changed bytes followed by those
+// bytes XORed with the base. Trailing unchanged bytes are left out. Never
+// writes more than size + size / MIN_GAP + 16 bytes.
+static size_t encodeDelta(const uint8_t *base, const uint8_t *data,
+                          size_t size, uint8_t *out) {
+  size_t in = 0;
+  size_t length = 0;
+
+  while (in < size) {
+    // Skip unchanged bytes a word at a time.
+    size_t start = in;
+    while (in + 8 <= size) {
+      uint64_t a, b;
+      memcpy(&a, base + in, 8);
+      memcpy(&b, data + in, 8);
+      if (a != b) break;
+      in += 8;
+    }
+    while (in < size && base[in] == data[in]) ++in;
+    if (in == size) break;
+
+    size_t runStart = in;
+    size_t unchanged = 0;
+    for (; in < size && unchanged < MIN_GAP; ++in)
+      unchanged = base[in] == data[in] ? unchanged + 1 : 0;
+    in -= unchanged;
+
+    length += writeVarint(out + length, runStart - start);
+    length += writeVarint(out + length, in - runStart);
+    for (size_t i = runStart; i < in; ++i) out[length++] = base[i] ^ data[i];
+  }
+
+  return length;
+}
+
+// XORs a delta from encodeDelta into `data`.
+static void applyDelta(const uint8_t *delta, size_t size, uint8_t *data) {
+  size_t in = 0;
+  size_t position = 0;
+
+  while (in < size) {
+    size_t skip, count;
+    in += readVarint(delta + in, skip);
+    in += readVarint(delta + in, count);
+    position += skip;
+    for (size_t i = 0; i < count; ++i) data[position + i] ^= delta[in + i];
+    position += count;
+    in += count;
+  }
+}
+
+RewindBuffer::RewindBuffer(size_t budgetBytes, size_t interval)
+    : arena(std::max(budgetBytes, 2 * sizeof(SaveState))),
+      keyframeInterval(std::max(interval, (size_t)1)),
+      current(std::make_unique<SaveState>()),
+      previous(std::make_unique<SaveState>()),
+      blank(std::make_unique<SaveState>()),
+      encoded(sizeof(SaveState) + sizeof(SaveState) / MIN_GAP + 16) {}
+
+void RewindBuffer::push(GameBoy &gameboy) {
+  gameboy.saveState(*current);
+
+  bool keyframe = needKeyframe || sinceKeyframe >= keyframeInterval;
+  size_t size = encode(keyframe);
+  reserve(size);
+
+  // Making room may have dropped the keyframe this delta depends on.
+  if (!keyframe && entries.empty()) {
+    keyframe = true;
+    size = encode(keyframe);
+    reserve(size);
+  }
+  memcpy(arena.data() + head, encoded.data(), size);
+  entries.push_back({head, size, keyframe});
+  head += size;
+  used += size;
+
+  sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+  needKeyframe = false;
+  std::swap(current, previous);
+}
+
+bool RewindBuffer::rewind(GameBoy &gameboy, size_t frames) {
+  if (frames == 0 || frames > entries.size()) return false;
+
+  size_t target = entries.size() - frames;
+  decode(target, *current);
+  gameboy.loadState(*current);
+
+  // Keep the state before the target around for the next push to diff
+  // against, unless the target starts a new keyframe.
+  needKeyframe = entries[target].keyframe;
+  if (!needKeyframe) {
+    decode(target - 1, *previous);
+    for (sinceKeyframe = 1; !entries[target - sinceKeyframe].keyframe;)
+      ++sinceKeyframe;
+  }
+
+  while (entries.size() > target) {
+    used -= entries.back().size;
+    entries.pop_back();
+  }
+  head = entries.empty() ? 0 : entries.back().offset + entries.back().size;
+  return true;
+}
+
+// Encodes `current` into `encoded`, whole or against `previous`.
+size_t RewindBuffer::encode(bool keyframe) {
+  const SaveState *base = keyframe ? blank.get() : previous.get();
+  return encodeDelta((const uint8_t *)base, (const uint8_t *)current.get(),
+                     sizeof(SaveState), encoded.data());
+}
+
+// Makes room for `size` contiguous bytes at head, wrapping around to the
+// start of the arena if the end is too close.
+void RewindBuffer::reserve(size_t size) {
+  if (head + size > arena.size()) head = 0;
+
+  while (!entries.empty() && entries.front().offset < head + size &&
+         head < entries.front().offset + entries.front().size)
+    dropOldestKeyframe();
+}
+
+// Deltas are useless without the keyframe before them, so they go together.
+void RewindBuffer::dropOldestKeyframe() {
+  do {
+    used -= entries.front().size;
+    entries.pop_front();
+  } while (!entries.empty() && !entries.front().keyframe);
+}
+
+// Rebuilds entry `index` from the keyframe before it.
+void RewindBuffer::decode(size_t index, SaveState &state) {
+  size_t keyframe = index;
+  while (!entries[keyframe].keyframe) --keyframe;
+
+  memset((void *)&state, 0, sizeof(SaveState));
+  for (size_t i = keyframe; i <= index; ++i)
+    applyDelta(arena.data() + entries[i].offset, entries[i].size,
+               (uint8_t *)&state);
+}
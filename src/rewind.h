@@ -0,0 +1,61 @@
+#pragma once
+
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "gameboy.h"
+#include "savestate.h"
+
+// Recent history of a GameBoy, one save state per push (e.g. every frame),
+// for stepping back while debugging. Every keyframeInterval-th state is
+// stored whole and the ones in between as the bytes that changed since the
+// state before, so a minute of frames usually costs a few MB. States are
+// packed into a fixed arena; once it's full, the oldest keyframe and its
+// deltas are dropped to make room.
+class RewindBuffer {
+ public:
+  // The budget is raised to at least two uncompressed states.
+  RewindBuffer(size_t budgetBytes, size_t keyframeInterval = 60);
+
+  void push(GameBoy &gameboy);
+
+  // Loads the state pushed `frames` pushes ago (1 being the latest) and
+  // forgets it along with everything newer, so holding a rewind key can call
+  // this once per frame. Returns false if that many aren't stored.
+  bool rewind(GameBoy &gameboy, size_t frames = 1);
+
+  size_t length() { return entries.size(); };
+  size_t bytesUsed() { return used; };
+
+ private:
+  struct Entry {
+    size_t offset;  // Into arena.
+    size_t size;
+    bool keyframe;
+  };
+
+  size_t encode(bool keyframe);
+  void reserve(size_t size);
+  void dropOldestKeyframe();
+  void decode(size_t index, SaveState &state);
+
+  std::vector<uint8_t> arena;
+  std::deque<Entry> entries;
+  size_t head = 0;  // Where the next entry goes.
+  size_t used = 0;
+
+  size_t keyframeInterval;
+  size_t sinceKeyframe = 0;
+  bool needKeyframe = true;  // The next push has no previous to diff with.
+
+  // Allocated once; pushing and rewinding don't touch the heap.
+  std::unique_ptr<SaveState> current;
+  std::unique_ptr<SaveState> previous;
+  std::unique_ptr<SaveState> blank;
+  std::vector<uint8_t> encoded;
+};
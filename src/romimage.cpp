@@ -0,0 +1,75 @@
+#include "romimage.h"
+
+#include <_types/_uint8_t.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+RomImage::~RomImage() {
+  if (mapped) munmap((void *)bytes, length);
+}
+
+// Whole banks, and at least the two mapped at 0x0000-0x7FFF.
+size_t RomImage::paddedSize(size_t size) {
+  size_t padded = std::max(size, MIN_SIZE);
+  return (padded + BANK_SIZE - 1) / BANK_SIZE * BANK_SIZE;
+}
+
+std::shared_ptr<RomImage> RomImage::open(const char *filename) {
+  int fd = ::open(filename, O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  std::shared_ptr<RomImage> image(new RomImage());
+  size_t size = (size_t)info.st_size;
+
+  if (size >= MIN_SIZE && size % BANK_SIZE == 0) {
+    void *address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (address != MAP_FAILED) {
+      close(fd);
+      image->bytes = (const uint8_t *)address;
+      image->length = size;
+      image->mapped = true;
+      return image;
+    }
+  }
+
+  // Short or odd-sized images (and filesystems that can't mmap) get a padded
+  // private copy so every mapped page is backed.
+  size_t padded = paddedSize(size);
+  image->copy.resize(padded, 0xFF);
+
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t count = pread(fd, image->copy.data() + offset, size - offset,
+                          (off_t)offset);
+    if (count <= 0) {
+      close(fd);
+      return NULL;
+    }
+    offset += (size_t)count;
+  }
+
+  close(fd);
+  image->bytes = image->copy.data();
+  image->length = padded;
+  return image;
+}
+
+std::shared_ptr<RomImage> RomImage::fromBytes(
+    const std::vector<uint8_t> &rom) {
+  std::shared_ptr<RomImage> image(new RomImage());
+  image->copy = rom;
+  image->copy.resize(paddedSize(rom.size()), 0xFF);
+  image->bytes = image->copy.data();
+  image->length = image->copy.size();
+  return image;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <_types/_uint8_t.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Read-only view of a ROM file. Images made of whole 16KB banks are mmapped
+// (shared, read-only), so opening one is O(1) and every emulator on the host
+// shares its physical pages. Anything else is copied and padded with 0xFF up
+// to whole banks.
+class RomImage {
+ public:
+  ~RomImage();
+
+  // Returns NULL if the file can't be read.
+  static std::shared_ptr<RomImage> open(const char *filename);
+
+  // A padded private copy of an image built in memory, e.g. by a test.
+  static std::shared_ptr<RomImage> fromBytes(const std::vector<uint8_t> &rom);
+
+  const uint8_t *data() { return bytes; };
+  size_t size() { return length; };
+
+  static constexpr size_t BANK_SIZE = 0x4000;
+  static constexpr size_t MIN_SIZE = 2 * BANK_SIZE;
+
+ private:
+  RomImage(){};
+
+  static size_t paddedSize(size_t size);
+
+  const uint8_t *bytes = NULL;
+  size_t length = 0;
+  bool mapped = false;
+  std::vector<uint8_t> copy;
+};
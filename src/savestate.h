@@ -0,0 +1,40 @@
+#pragma once
+
+#include <_types/_uint32_t.h>
+#include <_types/_uint64_t.h>
+
+#include <cstdint>
+#include <type_traits>
+
+#include "cartridge.h"
+#include "cpu.h"
+#include "mem.h"
+#include "ppu.h"
+#include "scheduler.h"
+
+// Everything needed to resume a GameBoy exactly where it left off, as one
+// flat block of plain data. Saving and loading are a handful of memcpys to
+// and from a state the caller allocates once (~220KB, mostly the address
+// space and cartridge RAM), so checkpoints are cheap enough to take every
+// frame. The layout is that of the build that wrote it, and the ROM and boot
+// ROM aren't included: a state only loads into a GameBoy running the same
+// version with the same cartridge inserted.
+struct SaveState {
+  static constexpr uint32_t MAGIC = 0x53424D47;  // "GMBS"
+  // Bump whenever any of the snapshots change.
+  static constexpr uint32_t VERSION = 2;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t romHash;  // See Cartridge::getRomHash, 0 without a cartridge.
+  uint64_t ticks;
+
+  CPU::Snapshot cpu;
+  Cartridge::Snapshot cartridge;
+  Memory::Snapshot memory;
+  PPU::Snapshot ppu;
+  Scheduler::Snapshot scheduler;
+};
+
+static_assert(std::is_trivially_copyable_v<SaveState>,
+              "save states are copied with memcpy");
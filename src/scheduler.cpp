@@ -0,0 +1,52 @@
+#include "scheduler.h"
+
+#include <_types/_uint64_t.h>
+
+#include <cstring>
+
+void Scheduler::schedule(SchedulerEvent event, uint64_t timestamp) {
+  deadlines[(size_t)event] = timestamp;
+  updateNext();
+}
+
+void Scheduler::cancel(SchedulerEvent event) {
+  deadlines[(size_t)event] = NEVER;
+  updateNext();
+}
+
+void Scheduler::clear() {
+  for (uint64_t &deadline : deadlines) deadline = NEVER;
+  next = NEVER;
+}
+
+void Scheduler::save(Snapshot &snapshot) {
+  memcpy(snapshot.deadlines, deadlines, sizeof(deadlines));
+}
+
+void Scheduler::load(const Snapshot &snapshot) {
+  memcpy(deadlines, snapshot.deadlines, sizeof(deadlines));
+  updateNext();
+}
+
+bool Scheduler::popDue(uint64_t now, SchedulerEvent &event,
+                       uint64_t &timestamp) {
+  if (next > now) return false;
+
+  for (size_t i = 0; i < (size_t)SchedulerEvent::COUNT; ++i) {
+    if (deadlines[i] == next) {
+      event = (SchedulerEvent)i;
+      timestamp = next;
+      deadlines[i] = NEVER;
+      updateNext();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void Scheduler::updateNext() {
+  next = NEVER;
+  for (uint64_t deadline : deadlines)
+    if (deadline < next) next = deadline;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <_types/_uint64_t.h>
+
+#include <cstddef>
+
+// Hardware events driven by the emulated clock. Timestamps are in T-cycles
+// since the GameBoy started running.
+enum class SchedulerEvent {
+  PPU,      // End of the current PPU mode.
+  DIVIDER,  // DIV increments every 256 T-cycles.
+  TIMER,    // TIMA increments at the rate selected by TAC.
+  COUNT
+};
+
+class Scheduler {
+ public:
+  Scheduler() { clear(); };
+
+  void schedule(SchedulerEvent event, uint64_t timestamp);
+  void cancel(SchedulerEvent event);
+  bool isScheduled(SchedulerEvent event) {
+    return deadlines[(size_t)event] != NEVER;
+  };
+  void clear();
+
+  // Timestamp of the earliest pending event.
+  uint64_t nextEventTime() { return next; };
+
+  // Removes and returns the earliest event due at or before `now`, along with
+  // the timestamp it was scheduled for. Returns false if nothing is due.
+  bool popDue(uint64_t now, SchedulerEvent &event, uint64_t &timestamp);
+
+  static constexpr uint64_t NEVER = ~(uint64_t)0;
+
+  struct Snapshot {
+    uint64_t deadlines[(size_t)SchedulerEvent::COUNT];
+  };
+  void save(Snapshot &snapshot);
+  void load(const Snapshot &snapshot);
+
+ private:
+  void updateNext();
+
+  // Only a handful of event kinds exist, each pending at most once, so a
+  // flat array scanned on change beats a heap.
+  uint64_t deadlines[(size_t)SchedulerEvent::COUNT];
+  uint64_t next;
+};
@@ -0,0 +1,56 @@
+#include "sdldisplay.h"
+
+#include <SDL_error.h>
+#include <SDL_pixels.h>
+#include <SDL_video.h>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+SDL_Display::SDL_Display(const char *name, int displayWidth,
+                         int displayHeight, int scaleFactor, bool hidden) {
+  this->displayHeight = displayHeight;
+  this->displayWidth = displayWidth;
+  this->scaleFactor = scaleFactor;
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    throw std::runtime_error("Failed to initialize SDL! SDL Error: " +
+                             std::string(SDL_GetError()));
+
+  window = SDL_CreateWindow(name, 100, 100, displayWidth * scaleFactor,
+                            displayHeight * scaleFactor,
+                            hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
+
+  if (window == NULL)
+    throw std::runtime_error("Failed to create SDL window! SDL Error: " +
+                             std::string(SDL_GetError()));
+
+  renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+
+  if (renderer == NULL)
+    throw std::runtime_error("Failed to create SDL renderer! SDL Error: " +
+                             std::string(SDL_GetError()));
+
+  // The texture stays at the native resolution; SDL_RenderCopy stretches it
+  // to fill the scaled window.
+  texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                              SDL_TEXTUREACCESS_STREAMING, displayWidth,
+                              displayHeight);
+
+  pixelBuffer =
+      (uint8_t *)malloc(sizeof(SDL_Color) * displayWidth * displayHeight);
+};
+
+SDL_Display::~SDL_Display() {
+  if (pixelBuffer != NULL) free(pixelBuffer);
+}
+
+void SDL_Display::update() {
+  SDL_UpdateTexture(texture, NULL, pixelBuffer, displayWidth * 4);
+}
+
+void SDL_Display::present() {
+  SDL_RenderCopy(renderer, texture, NULL, NULL);
+  SDL_RenderPresent(renderer);
+}
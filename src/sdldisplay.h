@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_render.h>
+#include <SDL_video.h>
+#include <_types/_uint8_t.h>
+
+class SDL_Display {
+ public:
+  SDL_Display(const char *name, int displayWidth, int displayHeight,
+              int scaleFactor, bool hidden);
+  ~SDL_Display();
+
+  int displayWidth;
+  int displayHeight;
+  int scaleFactor;
+
+  SDL_Window *window;
+  SDL_Renderer *renderer;
+  SDL_Texture *texture;
+  uint8_t *pixelBuffer;
+
+  // Copies pixelBuffer into the texture, then draws it to the window. Like
+  // all SDL calls these belong on the main thread.
+  void update();
+  void present();
+  void render() {
+    update();
+    present();
+  };
+};
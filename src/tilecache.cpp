@@ -0,0 +1,20 @@
+#include "tilecache.h"
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint8_t.h>
+
+#include "mem.h"
+#include "tiledecode.h"
+
+void TileCache::invalidateAll() {
+  ++version_;
+  for (bool &tileDirty : dirty) tileDirty = true;
+}
+
+void TileCache::decode(uint16_t tile) {
+  const uint8_t *data = memory->memory + 0x8000 + tile * 16;
+  for (int line = 0; line < 8; ++line)
+    decodeTileRow(data[line * 2], data[line * 2 + 1], tiles[tile][line]);
+
+  dirty[tile] = false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <_types/_uint16_t.h>
+#include <_types/_uint64_t.h>
+#include <_types/_uint8_t.h>
+
+#include <cstddef>
+
+class Memory;
+
+// Decoded copies of the 384 tiles in 0x8000-0x97FF, one color index (0-3) per
+// pixel. Memory routes VRAM writes through invalidate, and a dirty tile is
+// decoded again the next time one of its rows is asked for.
+class TileCache {
+ public:
+  TileCache(Memory *m) : memory(m) { invalidateAll(); };
+
+  // Row `line` of a tile as 8 color indices, leftmost first. Tiles are
+  // numbered from 0x8000, see PPU::tileIndex.
+  const uint8_t *row(uint16_t tile, uint8_t line) {
+    if (dirty[tile]) decode(tile);
+    return tiles[tile][line];
+  };
+
+  // Called by Memory on every write to 0x8000-0x9FFF.
+  void invalidate(uint16_t address) {
+    ++version_;
+    if (address < 0x9800) dirty[(address - 0x8000) / 16] = true;
+  };
+  void invalidateAll();
+
+  // Bumped by every VRAM write (tile maps included), so views can tell when
+  // there's nothing new to draw.
+  uint64_t version() { return version_; };
+
+  static const size_t TILE_COUNT = 384;
+
+ private:
+  void decode(uint16_t tile);
+
+  Memory *memory;
+  uint64_t version_ = 1;
+
+  uint8_t tiles[TILE_COUNT][8][8];
+  bool dirty[TILE_COUNT] = {};
+};
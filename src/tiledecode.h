@@ -0,0 +1,43 @@
+#pragma once
+
+#include <_types/_uint8_t.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Each tile row is stored as two bit planes: the first byte holds bit 0 of
+// every pixel's color index and the second byte bit 1, with the leftmost
+// pixel in bit 7.
+
+// Byte i of TILE_ROW_SPREAD[b] is bit (7 - i) of b, so two lookups, a shift
+// and an OR decode a whole row.
+inline constexpr std::array<std::array<uint8_t, 8>, 256> TILE_ROW_SPREAD = [] {
+  std::array<std::array<uint8_t, 8>, 256> table = {};
+  for (int b = 0; b < 256; ++b)
+    for (int i = 0; i < 8; ++i) table[b][i] = (b >> (7 - i)) & 1;
+  return table;
+}();
+
+// Expands a row's bit planes into 8 color indices (0-3), leftmost first.
+inline void decodeTileRow(uint8_t low, uint8_t high, uint8_t out[8]) {
+#if defined(__BMI2__)
+  // pdep scatters bit i into byte i; swapping the bytes puts the leftmost
+  // pixel (bit 7) first.
+  const uint64_t BYTE_LSBS = 0x0101010101010101ull;
+  uint64_t pixels = _pdep_u64(low, BYTE_LSBS) | _pdep_u64(high, BYTE_LSBS) << 1;
+  pixels = __builtin_bswap64(pixels);
+#else
+  // Every byte is 0 or 1, so shifting the whole word can't carry between
+  // pixels.
+  uint64_t lowBits, highBits;
+  memcpy(&lowBits, TILE_ROW_SPREAD[low].data(), 8);
+  memcpy(&highBits, TILE_ROW_SPREAD[high].data(), 8);
+  uint64_t pixels = lowBits | highBits << 1;
+#endif
+  memcpy(out, &pixels, 8);
+}
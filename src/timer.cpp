@@ -10,31 +10,21 @@
 
 bool Timer::isRunning() { return (memory->readByte(TAC_ADDR) & 0x4) != 0; }
 
-void Timer::run(int cycles) {
-  setDividerRegister(getDividerRegister() + cycles);
-  if (getDividerRegister() >= 256) {
-    setDividerRegister(getDividerRegister() - 256);
-    setDividerRegister(getDividerRegister() + 1);
-  }
-
-  if (isRunning()) {
-    setTimerCounter(getTimerCounter() + 1);
-
-    uint64_t frequency = getFrequency();
+void Timer::tickDivider() { ++memory->memory[DIV_ADDR]; }
 
-    while (getTimerCounter() >= (4194304 / frequency)) {
-      setTimerCounter(getTimerCounter() + 1);
+void Timer::tickCounter() {
+  uint8_t counter = getTimerCounter() + 1;
 
-      if (getTimerCounter() == 0x00) {
-        triggerTimerInterrupt();
-        setTimerCounter(getTimerModulo());
-      }
-
-      setTimerCounter(getTimerCounter() - (4194304 / frequency));
-    }
+  if (counter == 0x00) {
+    counter = getTimerModulo();
+    triggerTimerInterrupt();
   }
+
+  setTimerCounter(counter);
 }
 
+uint64_t Timer::getPeriod() { return 4194304 / getFrequency(); }
+
 uint64_t Timer::getFrequency() {
   int clockIndex = memory->readByte(TAC_ADDR) & 0x3;
   assert(clockIndex >= 0 && clockIndex < 4);
@@ -45,7 +45,16 @@ class Timer {
  public:
   Timer(Memory* m) : memory(m){};
 
-  void run(int cycles);
+  // Event handlers driven by the GameBoy scheduler. DIV advances every
+  // DIVIDER_PERIOD T-cycles and TIMA every getPeriod() T-cycles while the
+  // timer is running.
+  void tickDivider();
+  void tickCounter();
+
+  // T-cycles between TIMA increments at the selected input clock.
+  uint64_t getPeriod();
+
+  static constexpr uint64_t DIVIDER_PERIOD = 256;
 
   uint16_t getDividerRegister();
   uint8_t getTimerCounter();
@@ -0,0 +1,23 @@
+#include "triplebuffer.h"
+
+#include <_types/_uint8_t.h>
+
+TripleBuffer::TripleBuffer(size_t size) {
+  for (std::vector<uint8_t> &buffer : buffers) buffer.resize(size, 0);
+}
+
+void TripleBuffer::publish() {
+  // Release makes the frame's contents visible to the consumer's acquire.
+  uint8_t previous =
+      middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+  backIndex = previous & INDEX_MASK;
+}
+
+bool TripleBuffer::acquire() {
+  // Only the consumer clears FRESH, so once it's seen set the frame is ours.
+  if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+
+  uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+  frontIndex = previous & INDEX_MASK;
+  return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <_types/_uint8_t.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Passes frames from one producer thread to one consumer thread without
+// locks. Each side owns a buffer and the third sits between them; publishing
+// or acquiring a frame swaps a buffer with the middle one atomically. The
+// producer never waits, and the consumer always gets the latest frame,
+// skipping any it was too slow to see.
+class TripleBuffer {
+ public:
+  TripleBuffer(size_t size);
+
+  // Producer side: the buffer being filled, and handing it over once full.
+  uint8_t *back() { return buffers[backIndex].data(); };
+  void publish();
+
+  // Consumer side: takes the latest published frame if there is one newer
+  // than front().
+  bool acquire();
+  const uint8_t *front() { return buffers[frontIndex].data(); };
+
+ private:
+  std::vector<uint8_t> buffers[3];
+  uint8_t backIndex = 0;
+  uint8_t frontIndex = 1;
+
+  // Index of the middle buffer, with FRESH set while it holds a frame the
+  // consumer hasn't taken yet.
+  std::atomic<uint8_t> middle = 2;
+
+  static constexpr uint8_t FRESH = 0x04;
+  static constexpr uint8_t INDEX_MASK = 0x03;
+};